@@ -14,6 +14,7 @@
 #  limitations under the License.
 # ==================================================================================
 import time
+import socket
 import pandas as pd
 from influxdb import DataFrameClient, InfluxDBClient
 from configparser import ConfigParser
@@ -60,6 +61,11 @@ class DATABASE(object):
         self.client = None
         self.write_client = None # uses InfluxDBClient instead of DataFrameClient, which makes for easier writes
         self.decision_no = 0 # init decision_no to 0
+        self.sim_host = None # RAN simulator's handover decision port, decisions are only written to the database if not configured
+        self.sim_port = None
+        self.sim_sock = None
+        self.sim_retry_at = 0 # monotonic time before which the simulator isn't dialled again after failing to connect
+        self.sim_backoff = 1  # seconds to wait after the next failed connect, doubled on every failure up to 30
         self.config()
 
     def connect(self):
@@ -116,6 +122,54 @@ class DATABASE(object):
             logger.error('Failed to send decisions to influxdb')
             print(e)
 
+    def push_handovers(self, handovers):
+        """Pushes handover decisions straight to the RAN simulator's decision port, which executes them at its next tick
+        instead of having to poll the database for them
+
+        Parameters
+        ----------
+        handovers: Array of strings, same format as for write_handovers
+        """
+        if self.sim_host is None:
+            return
+
+        line = ("".join(s + ":" for s in handovers) + "\n").encode()
+
+        # the connection is kept open between decisions. If it breaks it is redialled once, but while the simulator
+        # can't be reached decisions are dropped (they are still in the database) rather than blocking on a connect
+        # for every message
+        for attempt in range(2):
+            if self.sim_sock is None and not self.connect_simulator():
+                return
+            try:
+                self.sim_sock.sendall(line)
+                return
+            except OSError as e:
+                logger.error('Lost connection to the simulator: {}'.format(e))
+                self.sim_sock.close()
+                self.sim_sock = None
+
+    def connect_simulator(self):
+        """Connects to the RAN simulator's decision port, unless a previous attempt failed less than the backoff ago
+
+        Returns
+        -------
+        bool: True if connected
+        """
+        now = time.monotonic()
+        if now < self.sim_retry_at:
+            return False
+
+        try:
+            self.sim_sock = socket.create_connection((self.sim_host, self.sim_port), timeout=1)
+            self.sim_backoff = 1
+            return True
+        except OSError as e:
+            logger.error('Failed to connect to the simulator, dropping decisions for {} s: {}'.format(self.sim_backoff, e))
+            self.sim_retry_at = now + self.sim_backoff
+            self.sim_backoff = min(self.sim_backoff * 2, 30)
+            return False
+
     def write_anomaly(self, df, meas='AD'):
         """Write data method for a given measurement
 
@@ -151,6 +205,10 @@ class DATABASE(object):
                 self.dbname = cfg.get(section, "database")
                 self.meas = cfg.get(section, "measurement")
 
+            if section == 'simulator':
+                self.sim_host = cfg.get(section, "host")
+                self.sim_port = cfg.getint(section, "decision_port")
+
             if section == 'features':
                 self.thpt = cfg.get(section, "thpt")
                 self.rsrp = cfg.get(section, "rsrp")
@@ -50,6 +50,7 @@ def entry(self):
                 # b'{"handovers": ["UE_5,RU_61,RU_52","UE_43,RU_61,RU_52","UE_15,RU_62,RU_52","UE_65,RU_62,RU_52"]}'
                 pl_json = json.loads(summary["payload"].decode()) # decode payload to dict
                 print("handovers: ", type(pl_json), pl_json)
+                db.push_handovers(pl_json["handovers"]) # send handovers straight to the simulator
                 db.write_handovers(pl_json["handovers"]) # send handover string for writing
 
             self.rmr_free(sbuf)
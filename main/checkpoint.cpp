@@ -0,0 +1,73 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "checkpoint.h"
+
+using namespace std;
+
+bool CheckpointFile::open(const string &path, const char *mode)
+{
+    offset = 0;
+    failed = true;
+
+    if (mode[0] == 'w')
+    {
+        file = fopen(path.c_str(), mode);
+        if (file == nullptr)
+            return false;
+
+        setvbuf(file, nullptr, _IOFBF, 1 << 20);
+        failed = false;
+        return true;
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        void *mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        if (mapping != MAP_FAILED)
+        {
+            data = (const char *)mapping;
+            size = st.st_size;
+            failed = false;
+        }
+    }
+
+    ::close(fd);
+    return !failed;
+}
+
+void CheckpointFile::close()
+{
+    if (file != nullptr && fclose(file) != 0)
+        failed = true;
+    if (data != nullptr)
+        munmap((void *)data, size);
+
+    file = nullptr;
+    data = nullptr;
+    size = 0;
+}
+
+const bool CheckpointFile::ok()
+{
+    return !failed;
+}
+
+const char *CheckpointFile::take(size_t count, size_t size)
+{
+    if (failed || count > (this->size - offset) / size)
+    {
+        failed = true;
+        return nullptr;
+    }
+
+    const char *bytes = data + offset;
+    offset += count * size;
+    return bytes;
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Binary checkpoint of the full simulation state, taken at a tick boundary so that a run can be resumed or branched from it
+// with the same results as if it had never stopped. Values are stored in native byte order and struct layout, so a
+// checkpoint can only be loaded by a build for the same platform. The layout is:
+//
+// CheckpointHeader
+// CheckpointRU[num_rus]
+// UE store, as written by UEStore::save
+// RU_conn: int32_t count[num_rus], then every RU's handles one after the other, in connection order
+// int32_t overloaded_rus[num_overloaded]         RUs waiting for a rebalance event
+// SimEvent[num_events]                           pending events
+// char rng_state[rng_bytes]                      rng and coord_distribution, as written by their operator<<
+//
+// Traffic sources are not stored, they are deterministic given the seed, so a restored run restarts them and skips the
+// arrivals that had already been admitted by the time of the checkpoint
+
+#define CHECKPOINT_MAGIC "EECHKPT1"
+
+struct CheckpointHeader
+{
+    char magic[8];             // CHECKPOINT_MAGIC, without the terminating null
+    uint32_t version;          // 1
+    uint32_t num_rus;
+    uint32_t grid_size;
+    uint32_t closest_rus;
+    uint32_t seed;
+    uint32_t traffic_sources;
+    float max_coord;
+    float tick_interval;
+    int64_t tick_no;           // last tick simulated before the checkpoint
+    double t;                  // simulation time of the checkpoint, in seconds
+    int32_t next_ue_id;        // i_ue, also the first UE id used by the traffic sources
+    int32_t num_sleeping_RUs;
+    double sim_tot_P;
+    double sim_tot_E;
+    double last_energy_t;
+    double last_rebalance_t;
+    int32_t rebalance_pending;
+    uint32_t num_overloaded;
+    uint64_t num_events;
+    int64_t next_event_seq;
+    uint64_t rng_bytes;
+};
+
+struct CheckpointRU
+{
+    float coords[2];
+    int32_t antennae;
+    int32_t bandwidth;
+    int32_t macro;     // 1 for macro-RUs, 0 for micro-RUs
+    int32_t alloc_PRB;
+    float p_tot;
+    double last_meas_t;
+};
+
+/// @brief Binary file that checkpoints are written to and read from. Writes are buffered, reads copy straight out of a
+/// memory mapping of the file so that arrays are filled in a single pass. Errors are sticky, so that a whole checkpoint can
+/// be written or read before checking ok once
+class CheckpointFile
+{
+private:
+    FILE *file = nullptr;         // when writing
+    const char *data = nullptr;   // when reading
+    size_t size = 0;
+    size_t offset = 0;
+    bool failed = false;
+
+    /// @brief Moves the read offset past count values of size bytes each
+    /// @return the values, or nullptr if the file ends before them
+    const char *take(size_t count, size_t size);
+
+public:
+    /// @param mode "wb" to write or "rb" to read
+    bool open(const std::string &path, const char *mode);
+    void close();
+    const bool ok();
+
+    template <typename T>
+    void put(const T *values, size_t n)
+    {
+        if (!failed && n > 0 && fwrite(values, sizeof(T), n, file) != n)
+            failed = true;
+    }
+
+    template <typename T>
+    void get(T *values, size_t n)
+    {
+        const char *bytes = take(n, sizeof(T));
+        if (bytes != nullptr)
+            memcpy((void *)values, bytes, sizeof(T) * n);
+    }
+
+    template <typename T>
+    void put(const T &value) { put(&value, 1); }
+
+    template <typename T>
+    void get(T &value) { get(&value, 1); }
+
+    template <typename T>
+    void put(const std::vector<T> &values) { put(values.data(), values.size()); }
+
+    /// @brief Reads n values into a vector, replacing its contents
+    template <typename T>
+    void get(std::vector<T> &values, size_t n)
+    {
+        const T *first = (const T *)take(n, sizeof(T));
+        if (first != nullptr)
+            values.assign(first, first + n);
+        else
+            values.clear();
+    }
+};
@@ -0,0 +1,183 @@
+#include <cmath>
+#include <algorithm>
+#include "compact_codec.h"
+
+using namespace std;
+
+static const char BASE64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/// @brief Streams bytes into base64 without buffering the whole payload, 3 bytes at a time
+struct Base64Writer
+{
+    string &out;
+    uint32_t bits = 0;
+    int num_bytes = 0;
+
+    Base64Writer(string &out) : out(out)
+    {
+        out.clear();
+        out += COMPACT_MARKER;
+    }
+
+    void put(uint8_t byte)
+    {
+        bits = (bits << 8) | byte;
+        if (++num_bytes == 3)
+        {
+            out += BASE64[(bits >> 18) & 63];
+            out += BASE64[(bits >> 12) & 63];
+            out += BASE64[(bits >> 6) & 63];
+            out += BASE64[bits & 63];
+            bits = 0;
+            num_bytes = 0;
+        }
+    }
+
+    void put_varint(uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            put((value & 0x7f) | 0x80);
+            value >>= 7;
+        }
+        put(value);
+    }
+
+    void finish()
+    {
+        // 1 leftover byte gives 2 characters, 2 leftover bytes give 3, no padding
+        if (num_bytes == 1)
+        {
+            out += BASE64[(bits >> 2) & 63];
+            out += BASE64[(bits << 4) & 63];
+        }
+        else if (num_bytes == 2)
+        {
+            out += BASE64[(bits >> 10) & 63];
+            out += BASE64[(bits >> 4) & 63];
+            out += BASE64[(bits << 2) & 63];
+        }
+    }
+};
+
+void encode_id_set(vector<int> &ids, string &out)
+{
+    sort(ids.begin(), ids.end());
+
+    Base64Writer writer(out);
+    int prev = 0;
+    for (int id : ids)
+    {
+        writer.put_varint(id - prev);
+        prev = id;
+    }
+    writer.finish();
+}
+
+void encode_id_list(const int *ids, int n, string &out)
+{
+    Base64Writer writer(out);
+    int prev = 0;
+    for (int i = 0; i < n; i++)
+    {
+        int delta = ids[i] - prev;
+        writer.put_varint(((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31)); // zigzag, small negative deltas stay small
+        prev = ids[i];
+    }
+    writer.finish();
+}
+
+void encode_sig_strs(const float *sig_strs, int n, string &out)
+{
+    Base64Writer writer(out);
+    for (int i = 0; i < n; i++)
+    {
+        uint16_t q = (uint16_t)lroundf(clamp(sig_strs[i], 0.0f, 1.0f) * 65535);
+        writer.put(q & 0xff);
+        writer.put(q >> 8);
+    }
+    writer.finish();
+}
+
+/// @brief Decodes the base64 part of a compact value into bytes
+static bool decode_base64(string_view str, vector<uint8_t> &bytes)
+{
+    if (str.empty() || str[0] != COMPACT_MARKER)
+        return false;
+
+    uint32_t bits = 0;
+    int num_bits = 0;
+    for (size_t i = 1; i < str.size(); i++)
+    {
+        const char *c = find(BASE64, BASE64 + 64, str[i]);
+        if (c == BASE64 + 64)
+            return false;
+
+        bits = (bits << 6) | (c - BASE64);
+        num_bits += 6;
+        if (num_bits >= 8)
+        {
+            num_bits -= 8;
+            bytes.push_back((bits >> num_bits) & 0xff);
+        }
+    }
+    return true;
+}
+
+/// @brief Reads LEB128 varints from bytes
+static bool decode_varints(const vector<uint8_t> &bytes, vector<uint32_t> &values)
+{
+    uint32_t value = 0;
+    int shift = 0;
+    for (uint8_t byte : bytes)
+    {
+        if (shift > 28)
+            return false;
+        value |= (uint32_t)(byte & 0x7f) << shift;
+        shift += 7;
+        if (!(byte & 0x80))
+        {
+            values.push_back(value);
+            value = 0;
+            shift = 0;
+        }
+    }
+    return shift == 0;
+}
+
+bool decode_id_set(string_view str, vector<int> &out)
+{
+    vector<uint8_t> bytes;
+    vector<uint32_t> deltas;
+    if (!decode_base64(str, bytes) || !decode_varints(bytes, deltas))
+        return false;
+
+    int id = 0;
+    for (uint32_t delta : deltas)
+        out.push_back(id += delta);
+    return true;
+}
+
+bool decode_id_list(string_view str, vector<int> &out)
+{
+    vector<uint8_t> bytes;
+    vector<uint32_t> deltas;
+    if (!decode_base64(str, bytes) || !decode_varints(bytes, deltas))
+        return false;
+
+    int id = 0;
+    for (uint32_t delta : deltas)
+        out.push_back(id += (int)(delta >> 1) ^ -(int)(delta & 1));
+    return true;
+}
+
+bool decode_sig_strs(string_view str, vector<float> &out)
+{
+    vector<uint8_t> bytes;
+    if (!decode_base64(str, bytes) || bytes.size() % 2 != 0)
+        return false;
+
+    for (size_t i = 0; i < bytes.size(); i += 2)
+        out.push_back((bytes[i] | bytes[i + 1] << 8) / 65535.0f);
+    return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Compact encoding of the connections, near_RU and near_RU_sig telemetry fields (telemetry_encoding = compact). Values start
+// with COMPACT_MARKER followed by unpadded standard base64 of the payload, so they stay valid line protocol strings and can
+// be told apart from the text format ("UE_1,UE_2," and so on) by their first character. Payloads are:
+//   id set (connections)     ids sorted ascending, the first one and then each difference to the previous id as a varint
+//   id list (near_RU)        each id's difference to the previous one (starting from 0), zigzag encoded as a varint
+//   signal strengths         each value in 0 - 1 quantized to a little-endian uint16 (value * 65535, rounded)
+// Varints are LEB128: 7 bits per byte, least significant group first, high bit set on all but the last byte.
+// qp_src/compact.py decodes the same format
+
+#define COMPACT_MARKER '~'
+
+/// @brief Encodes a set of ids, sorting them in place
+void encode_id_set(std::vector<int> &ids, std::string &out);
+
+/// @brief Encodes a list of ids, keeping their order
+void encode_id_list(const int *ids, int n, std::string &out);
+
+/// @brief Encodes signal strengths, quantizing them to steps of 1 / 65535
+void encode_sig_strs(const float *sig_strs, int n, std::string &out);
+
+/// @brief Decoders for the above, appending to out
+/// @return false if str isn't a valid compact value
+bool decode_id_set(std::string_view str, std::vector<int> &out);
+bool decode_id_list(std::string_view str, std::vector<int> &out);
+bool decode_sig_strs(std::string_view str, std::vector<float> &out);
@@ -1,8 +1,8 @@
 #include <iostream>
+#include <algorithm>
 #include "components.h"
 
 using namespace std;
-using namespace chrono;
 
 // ============
 // RU Functions
@@ -40,7 +40,7 @@ RU::RU()
 {
 }
 
-RU::RU(string uid, float coords[2], int antennae, int bandwidth, bool macro)
+RU::RU(string uid, const float coords[2], int antennae, int bandwidth, bool macro)
 {
     this->uid = uid;
     this->coords[0] = coords[0];
@@ -51,7 +51,6 @@ RU::RU(string uid, float coords[2], int antennae, int bandwidth, bool macro)
     // Calculate numPRBs
     this->num_PRB = bandwidth / 180000;               // num PRBs defined as bandwidth divided by size of 1 PRB (180 kHz)
     this->alloc_PRB = 2;                              // initial allocated PRBs: 2 (allocated for scanning purposes if i remember correct)
-    this->last_meas_t = high_resolution_clock::now(); // initialize last measure time to init time
     this->calc_p();
 
     if (macro) this->type = RUType::macro;
@@ -90,6 +89,32 @@ const std::string RU::get_type_string()
     return ""; // should be unreachable
 }
 
+/// @brief Gives the distance at which the RU's signal strength reaches zero
+/// @return the range of the RU in meters (2000 for macro-RUs, 500 for micro-RUs)
+const float RU::get_range()
+{
+    switch (this->type)
+    {
+        case RUType::macro:
+            return 2000;
+
+        case RUType::micro:
+            return 500;
+    }
+
+    return 0; // should be unreachable
+}
+
+const int RU::get_antennae()
+{
+    return this->antennae;
+}
+
+const int RU::get_bandwidth()
+{
+    return this->bandwidth;
+}
+
 const int RU::get_num_PRB()
 {
     return this->num_PRB;
@@ -100,12 +125,12 @@ const int RU::get_alloc_PRB()
     return this->alloc_PRB;
 }
 
-float RU::calc_delta_p()
+float RU::calc_delta_p(double now)
 {
-    duration<float> delta_t = duration_cast<duration<float>>(high_resolution_clock::now() - last_meas_t);
-    last_meas_t = high_resolution_clock::now();
-    // cout << this->uid << " delta_t: " << delta_t.count() << "\n";
-    float delta_p = delta_t.count() * this->p;
+    float delta_t = now - last_meas_t;
+    last_meas_t = now;
+    // cout << this->uid << " delta_t: " << delta_t << "\n";
+    float delta_p = delta_t * this->p;
     // cout << this->uid << " delta_p: " << delta_p << "\n";
     p_tot += delta_p;
     return delta_p;
@@ -121,59 +146,260 @@ const float RU::get_p_tot()
     return this->p_tot;
 }
 
+const double RU::get_last_meas_t()
+{
+    return this->last_meas_t;
+}
+
+void RU::restore_energy(float p_tot, double last_meas_t)
+{
+    this->p_tot = p_tot;
+    this->last_meas_t = last_meas_t;
+}
+
 void RU::set_alloc_PRB(int a_PRB)
 {
     this->alloc_PRB = a_PRB;
     this->calc_p();
 }
 
-// ============
-// UE Functions
-// ============
+// =================
+// UEStore Functions
+// =================
 
-UE::UE(string uid, float coords[2], float timer)
+void UEStore::set_closest_rus(int k)
 {
-    this->uid = uid;
-    this->coords[0] = coords[0];
-    this->coords[1] = coords[1];
-    this->timer = timer;
-    this->last_meas_t = high_resolution_clock::now(); // initialize last measure time to init time
+    if (this->ids.empty()) this->closest_rus = k;
 }
 
-const string UE::get_UID()
+const int UEStore::get_closest_rus()
 {
-    return this->uid;
+    return this->closest_rus;
 }
 
-const float *UE::get_coords()
+UEHandle UEStore::add(int id, const float coords[2], double expiry, int prb_demand)
 {
-    return this->coords;
+    UEHandle ue;
+
+    if (free_slots.empty())
+    {
+        ue = this->ids.size();
+        this->ids.push_back(id);
+        this->coords.push_back(coords[0]);
+        this->coords.push_back(coords[1]);
+        this->prb_demand.push_back(prb_demand);
+        this->expiry.push_back(expiry);
+        this->sig_arrs.resize(this->sig_arrs.size() + closest_rus);
+        this->conn_ru.push_back(-1);
+        this->conn_slot.push_back(-1);
+    }
+
+    else
+    {
+        ue = free_slots.back();
+        free_slots.pop_back();
+        this->ids[ue] = id;
+        this->coords[ue * 2] = coords[0];
+        this->coords[ue * 2 + 1] = coords[1];
+        this->prb_demand[ue] = prb_demand;
+        this->expiry[ue] = expiry;
+        fill_n(this->sig_arrs.begin() + ue * closest_rus, closest_rus, RU_entry());
+        this->conn_ru[ue] = -1;
+        this->conn_slot[ue] = -1;
+    }
+
+    if (id >= (int)id_index.size())
+        id_index.resize(id + 1, -1);
+    id_index[id] = ue;
+    expiries.push_back(ExpiryEntry{expiry, ue, id});
+    push_heap(expiries.begin(), expiries.end(), greater<ExpiryEntry>());
+    num_ues++;
+    return ue;
+}
+
+void UEStore::remove(UEHandle ue)
+{
+    id_index[this->ids[ue]] = -1;
+    this->ids[ue] = -1;
+    free_slots.push_back(ue);
+    num_ues--;
+}
+
+const bool UEStore::valid(UEHandle ue)
+{
+    return ue >= 0 && ue < (int)this->ids.size() && this->ids[ue] >= 0;
+}
+
+const UEHandle UEStore::find(int id)
+{
+    if (id < 0 || id >= (int)id_index.size()) return -1;
+
+    return id_index[id];
 }
 
-const int UE::get_demand()
+const int UEStore::size()
 {
-    return this->prb_demand;
+    return this->num_ues;
 }
 
-const RU_entry *UE::get_sig_arr()
+const int UEStore::capacity()
 {
-    return this->sig_arr;
+    return this->ids.size();
 }
 
-bool UE::decrement_timer()
+const string UEStore::get_UID(UEHandle ue)
 {
-    duration<float> delta_t = duration_cast<duration<float>>(high_resolution_clock::now() - last_meas_t);
-    last_meas_t = high_resolution_clock::now();
-    this->timer -= delta_t.count();
-    if (this->timer <= 0) return true;
+    return "UE_" + to_string(this->ids[ue]);
+}
 
-    return false;
+const int UEStore::get_id(UEHandle ue)
+{
+    return this->ids[ue];
 }
 
-void UE::set_sig_arr(RU_entry new_sig_arr[UE_CLOSEST_RUS])
+const float *UEStore::get_coords(UEHandle ue)
 {
-    for (size_t i = 0; i < UE_CLOSEST_RUS; i++)
+    return &this->coords[ue * 2];
+}
+
+const int UEStore::get_demand(UEHandle ue)
+{
+    return this->prb_demand[ue];
+}
+
+void UEStore::set_demand(UEHandle ue, int prb_demand)
+{
+    this->prb_demand[ue] = prb_demand;
+}
+
+const RU_entry *UEStore::get_sig_arr(UEHandle ue)
+{
+    return &this->sig_arrs[ue * closest_rus];
+}
+
+RU_entry *UEStore::edit_sig_arr(UEHandle ue)
+{
+    return &this->sig_arrs[ue * closest_rus];
+}
+
+void UEStore::set_sig_arr(UEHandle ue, const RU_entry *new_sig_arr)
+{
+    copy_n(new_sig_arr, closest_rus, this->sig_arrs.begin() + ue * closest_rus);
+}
+
+const int UEStore::get_ru(UEHandle ue)
+{
+    return this->conn_ru[ue];
+}
+
+const int UEStore::get_slot(UEHandle ue)
+{
+    return this->conn_slot[ue];
+}
+
+void UEStore::set_location(UEHandle ue, int ru_index, int slot)
+{
+    this->conn_ru[ue] = ru_index;
+    this->conn_slot[ue] = slot;
+}
+
+const double UEStore::get_expiry(UEHandle ue)
+{
+    return this->expiry[ue];
+}
+
+UEHandle UEStore::pop_expired(double now)
+{
+    while (!expiries.empty() && expiries.front().t <= now)
     {
-        this->sig_arr[i] = new_sig_arr[i];
+        pop_heap(expiries.begin(), expiries.end(), greater<ExpiryEntry>());
+        ExpiryEntry e = expiries.back();
+        expiries.pop_back();
+
+        // skip entries of UEs that were removed some other way
+        if (this->ids[e.ue] == e.id && this->expiry[e.ue] == e.t)
+            return e.ue;
     }
+
+    return -1;
+}
+
+void UEStore::save(CheckpointFile &file)
+{
+    uint64_t counts[4] = {this->ids.size(), this->free_slots.size(), this->id_index.size(), this->expiries.size()};
+    file.put(counts, 4);
+    file.put(this->ids);
+    file.put(this->coords);
+    file.put(this->prb_demand);
+    file.put(this->expiry);
+    file.put(this->sig_arrs);
+    file.put(this->conn_ru);
+    file.put(this->conn_slot);
+    file.put(this->free_slots);
+    file.put(this->id_index);
+    file.put(this->expiries);
+}
+
+bool UEStore::load(CheckpointFile &file, int closest_rus, int num_rus)
+{
+    uint64_t counts[4] = {};
+    file.get(counts, 4);
+    uint64_t capacity = counts[0];
+
+    this->closest_rus = closest_rus;
+    file.get(this->ids, capacity);
+    file.get(this->coords, capacity * 2);
+    file.get(this->prb_demand, capacity);
+    file.get(this->expiry, capacity);
+    file.get(this->sig_arrs, capacity * closest_rus);
+    file.get(this->conn_ru, capacity);
+    file.get(this->conn_slot, capacity);
+    file.get(this->free_slots, counts[1]);
+    file.get(this->id_index, counts[2]);
+    file.get(this->expiries, counts[3]);
+    num_ues = capacity - this->free_slots.size();
+    if (!file.ok())
+        return false;
+
+    // Handles and RU indices are used without bounds checks from here on, so every one of them is checked once
+    auto in_store = [capacity](UEHandle ue)
+    { return ue >= 0 && (uint64_t)ue < capacity; };
+
+    for (auto &&ue : this->free_slots)
+    {
+        if (!in_store(ue) || this->ids[ue] != -1)
+            return false;
+    }
+    for (size_t id = 0; id < this->id_index.size(); id++)
+    {
+        UEHandle ue = this->id_index[id];
+        if (ue != -1 && (!in_store(ue) || this->ids[ue] != (int)id))
+            return false;
+    }
+    for (auto &&e : this->expiries)
+    {
+        if (!in_store(e.ue))
+            return false;
+    }
+
+    int live = 0;
+    for (uint64_t ue = 0; ue < capacity; ue++)
+    {
+        int id = this->ids[ue];
+        if (id == -1)
+            continue;
+        if (id < 0 || (size_t)id >= this->id_index.size() || this->id_index[id] != (UEHandle)ue ||
+            this->conn_ru[ue] < -1 || this->conn_ru[ue] >= num_rus)
+            return false;
+        for (int i = 0; i < closest_rus; i++)
+        {
+            int ru = this->sig_arrs[ue * closest_rus + i].ru;
+            if (ru < 0 || ru >= num_rus)
+                return false;
+        }
+        live++;
+    }
+
+    // Free slots all hold no UE, so the count is off if a slot is listed as free twice or is neither live nor listed
+    return live == num_ues;
 }
@@ -1,7 +1,9 @@
 #pragma once
-#include <chrono>
+#include <string>
+#include <vector>
 #include <map>
 #include "constants.h"
+#include "checkpoint.h"
 
 enum RUType
 {
@@ -20,41 +22,51 @@ private:
     int num_PRB;                 // number of physical resource blocks, depends on the bandwidth
     int alloc_PRB;               // number of physical resource blocks that have been allocated to UE
 
-    float p;                                                // power consumption, dependent on current traffic load, measured in mW
-    float p_tot = 0;                                        // total power consumption since t = 0, measured in mWs (milliwattsecond which is 0,001 J)
-    std::chrono::_V2::system_clock::time_point last_meas_t; // time since last delta measurement of power consumption
+    float p;                // power consumption, dependent on current traffic load, measured in mW
+    float p_tot = 0;        // total power consumption since t = 0, measured in mWs (milliwattsecond which is 0,001 J)
+    double last_meas_t = 0; // simulation time of last delta measurement of power consumption
 
     void calc_p();
 
 public:
     RU();
-    RU(std::string uid, float coords[2], int antennae, int bandwidth, bool macro = false);
+    RU(std::string uid, const float coords[2], int antennae, int bandwidth, bool macro = false);
 
     const std::string get_UID();
     const float *get_coords();
     const RUType get_type();
     const std::string get_type_string();
+    const float get_range();
+    const int get_antennae();
+    const int get_bandwidth();
     const int get_num_PRB();
     const int get_alloc_PRB();
-    float calc_delta_p();
+    /// @brief Integrates power consumption since the last measurement into p_tot
+    /// @param now the current simulation time, in seconds
+    /// @return the energy consumed since the last measurement, in mWs
+    float calc_delta_p(double now);
     const float get_p();
     const float get_p_tot();
+    const double get_last_meas_t();
     void set_alloc_PRB(int a_PRB);
+
+    /// @brief Sets the energy consumed so far and the time it was last measured, when restoring the RU from a checkpoint
+    void restore_energy(float p_tot, double last_meas_t);
 };
 
-// RU entry for use in the dist_list in UE class
+// RU entry for use in the sig_arr of each UE
 struct RU_entry
 {
-    RU *ru;
+    int ru;        // index of the RU in sim_RUs, -1 if empty
     float sig_str;
 
     RU_entry()
     {
-        ru = nullptr;
+        ru = -1;
         sig_str = -1;
     }
 
-    RU_entry(RU *ru, float sig_str)
+    RU_entry(int ru, float sig_str)
     {
         this->ru = ru;
         this->sig_str = sig_str;
@@ -71,33 +83,89 @@ struct RU_entry
     }
 };
 
-class UE
+typedef int UEHandle; // slot of a UE in the UEStore, stays the same for as long as the UE is alive
+
+/// @brief Central storage of all UEs in the simulation, kept as dense arrays (one entry per slot) rather than one object per UE.
+/// Slots of removed UEs are reused by later UEs, so a handle must not be used after its UE has been removed.
+class UEStore
 {
 private:
-    std::string uid;
-    float coords[2]; // x, y coords
-
-    int prb_demand = 2;                                     // amount of physical resource blocks that the traffic of this UE demands
-    float timer;                                            // time until UE expires
-    RU_entry sig_arr[UE_CLOSEST_RUS];                       // array of n closest RUs
-    std::chrono::_V2::system_clock::time_point last_meas_t; // time since last timer decrement
-
-public:
-    UE(std::string uid, float coords[2], float timer);
-
-    const std::string get_UID();
-    const float *get_coords();
-    const int get_demand();
-    const RU_entry *get_sig_arr();
-
-    /// @brief Decrements the UE's timer by the time that's passed since last measurement
-    /// @return Returns true if resulting time after decrementing reaches zero or below, false otherwise
-    bool decrement_timer();
-
-    bool operator==(UE const &ue)
+    std::vector<int> ids;            // numeric part of each UE's uid ("UE_<id>"), -1 for free slots
+    std::vector<float> coords;       // x, y coords, 2 per slot
+    std::vector<int> prb_demand;     // amount of physical resource blocks that the traffic of each UE demands
+    std::vector<double> expiry;      // simulation time at which each UE expires
+    std::vector<RU_entry> sig_arrs;  // n closest RUs of each UE, closest_rus per slot
+    std::vector<int> conn_ru;        // index of the RU each UE is connected to, -1 if not connected
+    std::vector<int> conn_slot;      // position of each UE in its RU's RU_conn list
+    std::vector<UEHandle> free_slots;
+    std::vector<UEHandle> id_index;  // handle of each UE id, -1 for ids without a live UE. UE ids are handed out in
+                                     // sequence, so this stays dense and can be saved and restored as is
+
+    // Min-heap of upcoming expiries (std::push_heap/pop_heap with std::greater), entries of UEs that have since been removed are
+    // skipped when popped
+    struct ExpiryEntry
     {
-        return (ue.uid.compare(this->uid) == 0);
-    }
+        double t;
+        UEHandle ue;
+        int id; // tells apart the UE the entry was made for from a later UE reusing the same slot
+
+        bool operator>(ExpiryEntry const &e) const
+        {
+            return (t > e.t) || (t == e.t && id > e.id);
+        }
+    };
+    std::vector<ExpiryEntry> expiries;
+    int num_ues = 0;
+    int closest_rus = UE_CLOSEST_RUS;
 
-    void set_sig_arr(RU_entry *new_sig_arr);
+public:
+    /// @brief Sets the number of nearby RUs kept per UE, can only be changed while the store is empty
+    void set_closest_rus(int k);
+    const int get_closest_rus();
+
+    /// @brief Adds a UE to the store, reusing a free slot if there is one
+    /// @return the handle of the new UE
+    /// @param expiry the simulation time at which the UE expires
+    UEHandle add(int id, const float coords[2], double expiry, int prb_demand = 2);
+
+    /// @brief Frees the slot of a UE, after which its handle is no longer valid
+    void remove(UEHandle ue);
+
+    const bool valid(UEHandle ue);
+
+    /// @brief Looks up a UE by the numeric part of its uid
+    /// @return the handle of the UE, or -1 if no such UE exists
+    const UEHandle find(int id);
+    const int size();     // number of UEs in the store
+    const int capacity(); // number of slots in the store, handles range from 0 to capacity() - 1
+
+    const std::string get_UID(UEHandle ue);
+    const int get_id(UEHandle ue);
+    const float *get_coords(UEHandle ue);
+    const int get_demand(UEHandle ue);
+    void set_demand(UEHandle ue, int prb_demand);
+    const RU_entry *get_sig_arr(UEHandle ue);
+    RU_entry *edit_sig_arr(UEHandle ue);
+    void set_sig_arr(UEHandle ue, const RU_entry *new_sig_arr);
+    const int get_ru(UEHandle ue);
+    const int get_slot(UEHandle ue);
+    void set_location(UEHandle ue, int ru_index, int slot);
+
+    const double get_expiry(UEHandle ue);
+
+    /// @brief Pops the next UE that has expired by the given time, in order of expiry. Only UEs that expire are ever
+    /// looked at, so calling this every tick costs nothing for UEs that are still alive
+    /// @param now the current simulation time
+    /// @return the handle of an expired UE, or -1 if no UE has expired yet
+    UEHandle pop_expired(double now);
+
+    /// @brief Writes the whole store to a checkpoint: a uint64_t count of slots, free slots, id index entries and expiry
+    /// heap entries, followed by each array in the order they are declared in
+    void save(CheckpointFile &file);
+
+    /// @brief Replaces the contents of the store with what save wrote, as is, so restoring costs no more than copying it
+    /// @param num_rus number of RUs in the checkpoint, which the connections and closest RUs of the UEs must be below
+    /// @return false if the file is cut short or the store doesn't hold together: a handle outside of the store, an id
+    /// index or free slot that doesn't match the ids, or an RU that doesn't exist
+    bool load(CheckpointFile &file, int closest_rus, int num_rus);
 };
\ No newline at end of file
@@ -0,0 +1,291 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+#include <arpa/inet.h>
+#include "config.h"
+
+using namespace std;
+
+SimConfig sim_cfg;
+
+/// @brief Applies a single key/value pair to the config
+/// @return false if the key is unknown or the value is malformed
+static bool set_option(SimConfig &cfg, const string &key, const string &value, bool &macros_given)
+{
+    istringstream in(value);
+
+    if (key == "grid_size") in >> cfg.grid_size;
+    else if (key == "closest_rus") in >> cfg.closest_rus;
+    else if (key == "max_coord") in >> cfg.max_coord;
+    else if (key == "margin") in >> cfg.margin;
+    else if (key == "initial_ues") in >> cfg.initial_ues;
+    else if (key == "duration") in >> cfg.duration;
+    else if (key == "seed") in >> cfg.seed;
+    else if (key == "tick_interval") in >> cfg.tick_interval;
+    else if (key == "macro_stride") in >> cfg.macro_stride;
+    else if (key == "threads") in >> cfg.threads;
+    else if (key == "traffic_sources") in >> cfg.traffic_sources;
+    else if (key == "telemetry_buffer") in >> cfg.telemetry_buffer;
+    else if (key == "telemetry_late") in >> cfg.telemetry_late;
+    else if (key == "telemetry_heartbeat") in >> cfg.telemetry_heartbeat;
+    else if (key == "telemetry_total_every") in >> cfg.telemetry_total_every;
+    else if (key == "decision_port") in >> cfg.decision_port;
+    else if (key == "decision_address") cfg.decision_address = value;
+    else if (key == "trace_file") cfg.trace_file = value;
+    else if (key == "checkpoint_file") cfg.checkpoint_file = value;
+    else if (key == "checkpoint_every") in >> cfg.checkpoint_every;
+    else if (key == "checkpoint_load") cfg.checkpoint_load = value;
+    else if (key == "record_file") cfg.record_file = value;
+    else if (key == "replay_file") cfg.replay_file = value;
+    else if (key == "influxdb_url") cfg.influxdb_url = value;
+    else if (key == "telemetry_file") cfg.telemetry_file = value;
+    else if (key == "telemetry_file_bytes") in >> cfg.telemetry_file_bytes;
+    else if (key == "telemetry_file_keep") in >> cfg.telemetry_file_keep;
+    else if (key == "telemetry_ring") in >> cfg.telemetry_ring;
+    else if (key == "telemetry_sink")
+    {
+        if (value == "influx") cfg.telemetry_sink = TelemetrySinkType::influx;
+        else if (value == "null") cfg.telemetry_sink = TelemetrySinkType::null;
+        else if (value == "file") cfg.telemetry_sink = TelemetrySinkType::file;
+        else if (value == "memory") cfg.telemetry_sink = TelemetrySinkType::memory;
+        else in.setstate(ios::failbit);
+    }
+    else if (key == "decision_source")
+    {
+        if (value == "socket") cfg.decision_source = DecisionSource::socket;
+        else if (value == "influx") cfg.decision_source = DecisionSource::influx;
+        else if (value == "none") cfg.decision_source = DecisionSource::none;
+        else in.setstate(ios::failbit);
+    }
+    else if (key == "telemetry_mode")
+    {
+        if (value == "full") cfg.telemetry_mode = TelemetryMode::full;
+        else if (value == "changes") cfg.telemetry_mode = TelemetryMode::changes;
+        else in.setstate(ios::failbit);
+    }
+    else if (key == "telemetry_encoding")
+    {
+        if (value == "text") cfg.telemetry_encoding = TelemetryEncoding::text;
+        else if (value == "compact") cfg.telemetry_encoding = TelemetryEncoding::compact;
+        else in.setstate(ios::failbit);
+    }
+    else if (key == "telemetry_policy")
+    {
+        if (value == "block") cfg.telemetry_policy = OverflowPolicy::block;
+        else if (value == "drop-oldest") cfg.telemetry_policy = OverflowPolicy::drop_oldest;
+        else if (value == "coalesce") cfg.telemetry_policy = OverflowPolicy::coalesce;
+        else in.setstate(ios::failbit);
+    }
+    else if (key == "clock")
+    {
+        if (value == "realtime") cfg.clock = ClockMode::realtime;
+        else if (value == "event") cfg.clock = ClockMode::event;
+        else in.setstate(ios::failbit);
+    }
+    else if (key == "macro")
+    {
+        // the first macro given replaces the default ones
+        if (!macros_given) cfg.macros.clear();
+        macros_given = true;
+
+        if (value == "none") return true;
+
+        MacroPlacement macro;
+        in >> macro.ru_index >> macro.coords[0] >> macro.coords[1];
+        cfg.macros.push_back(macro);
+    }
+    else
+    {
+        cout << "Error: unknown option " << key << endl;
+        return false;
+    }
+
+    if (in.fail())
+    {
+        cout << "Error: invalid value \"" << value << "\" for " << key << endl;
+        return false;
+    }
+
+    return true;
+}
+
+/// @brief Checks that the config describes a topology that can be simulated
+static bool validate(SimConfig &cfg)
+{
+    if (cfg.grid_size < 1 || cfg.closest_rus < 1 || cfg.threads < 1 || cfg.traffic_sources < 0 || cfg.max_coord <= 0 || cfg.tick_interval <= 0 || cfg.initial_ues < 0 || cfg.duration < 0)
+    {
+        cout << "Error: grid_size, closest_rus and threads must be at least 1, max_coord and tick_interval must be positive and initial_ues, traffic_sources, duration must not be negative" << endl;
+        return false;
+    }
+
+    if (cfg.decision_port < 1 || cfg.decision_port > 65535)
+    {
+        cout << "Error: decision_port must be between 1 and 65535" << endl;
+        return false;
+    }
+
+    in_addr decision_addr;
+    if (inet_pton(AF_INET, cfg.decision_address.c_str(), &decision_addr) != 1)
+    {
+        cout << "Error: decision_address must be an IPv4 address like 127.0.0.1" << endl;
+        return false;
+    }
+
+    if (cfg.telemetry_sink == TelemetrySinkType::file && (cfg.telemetry_file.empty() || cfg.telemetry_file_bytes < 1 || cfg.telemetry_file_keep < 0))
+    {
+        cout << "Error: the file sink needs a telemetry_file, a telemetry_file_bytes of at least 1 and a telemetry_file_keep that is not negative" << endl;
+        return false;
+    }
+
+    if (cfg.checkpoint_every < 0)
+    {
+        cout << "Error: checkpoint_every must not be negative" << endl;
+        return false;
+    }
+
+    if (!cfg.record_file.empty() && cfg.record_file == cfg.replay_file)
+    {
+        cout << "Error: record_file and replay_file must not be the same file" << endl;
+        return false;
+    }
+
+    if (cfg.telemetry_ring < 1)
+    {
+        cout << "Error: telemetry_ring must be at least 1" << endl;
+        return false;
+    }
+
+    if (cfg.telemetry_buffer < 2 || cfg.telemetry_late < 0 || cfg.telemetry_heartbeat < 1 || cfg.telemetry_total_every < 1)
+    {
+        cout << "Error: telemetry_buffer must be at least 2, telemetry_heartbeat and telemetry_total_every at least 1 and telemetry_late must not be negative" << endl;
+        return false;
+    }
+
+    if (cfg.closest_rus > cfg.num_rus())
+    {
+        cout << "Error: closest_rus (" << cfg.closest_rus << ") can not be larger than the number of RUs (" << cfg.num_rus() << ")" << endl;
+        return false;
+    }
+
+    for (auto &&macro : cfg.macros)
+    {
+        if (macro.ru_index < 0 || macro.ru_index >= cfg.num_rus())
+        {
+            cout << "Error: macro-RU index " << macro.ru_index << " is outside of the grid" << endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool load_scenario(SimConfig &cfg, const string &path)
+{
+    ifstream file(path);
+    if (!file)
+    {
+        cout << "Error: could not open scenario file " << path << endl;
+        return false;
+    }
+
+    bool macros_given = false;
+    string line;
+    while (getline(file, line))
+    {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == string::npos || line[start] == '#' || line[start] == '[')
+            continue;
+
+        size_t eq = line.find('=');
+        if (eq == string::npos)
+        {
+            cout << "Error: expected \"key = value\" in scenario file, got: " << line << endl;
+            return false;
+        }
+
+        string key = line.substr(start, line.find_last_not_of(" \t", eq - 1) + 1 - start);
+        string value = line.substr(eq + 1);
+        value.erase(min(value.find('#'), value.size())); // strip trailing comments
+        value.erase(0, value.find_first_not_of(" \t"));
+        value.erase(value.find_last_not_of(" \t\r") + 1);
+
+        if (!set_option(cfg, key, value, macros_given))
+            return false;
+    }
+
+    return true;
+}
+
+bool parse_args(SimConfig &cfg, int argc, char **argv)
+{
+    // Load scenario file first, if any
+    for (int i = 1; i < argc - 1; i++)
+    {
+        if (strcmp(argv[i], "--scenario") == 0 && !load_scenario(cfg, argv[i + 1]))
+            return false;
+    }
+
+    bool macros_given = false;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "-h" || arg == "--help" || arg.rfind("--", 0) != 0 || i + 1 >= argc)
+        {
+            print_usage(argv[0]);
+            return false;
+        }
+
+        // --max-coord becomes max_coord and so on
+        string key = arg.substr(2);
+        replace(key.begin(), key.end(), '-', '_');
+        i++;
+
+        if (key != "scenario" && !set_option(cfg, key, argv[i], macros_given))
+            return false;
+    }
+
+    return validate(cfg);
+}
+
+void print_usage(const char *program)
+{
+    cout << "Usage: " << program << " [options]\n"
+         << "  --scenario <file>       read options from a scenario file of \"key = value\" lines\n"
+         << "  --grid-size <n>         side length of the RU grid (default " << GRID_SIZE << ")\n"
+         << "  --closest-rus <k>       number of nearby RUs each UE keeps track of (default " << UE_CLOSEST_RUS << ")\n"
+         << "  --max-coord <m>         side length of the map in meters (default 5000)\n"
+         << "  --margin <f>            fraction of the map left between its edges and the RU grid (default 0.2)\n"
+         << "  --initial-ues <n>       number of UEs spawned at startup (default 80)\n"
+         << "  --duration <s>          simulation duration in seconds (default 300)\n"
+         << "  --seed <n>              random seed (default 42)\n"
+         << "  --clock <mode>          realtime (default) paces the simulation after the wall clock, event runs it as fast as possible\n"
+         << "  --tick-interval <s>     simulation time between ticks in seconds (default 0.01)\n"
+         << "  --threads <n>           number of threads processing each tick, RUs are split evenly between them (default 1)\n"
+         << "  --traffic-sources <n>   number of threads spawning UEs, each adding a UE every 0.3 - 0.6 seconds (default 1)\n"
+         << "  --telemetry-sink <s>    where telemetry goes: influx (default), null, file (rotating, see below) or memory (ring of the latest ticks)\n"
+         << "  --telemetry-file <path> file written by the file sink (default telemetry.lp)\n"
+         << "  --telemetry-file-bytes <n> size in bytes at which the file sink rotates its file (default 64 MiB)\n"
+         << "  --telemetry-file-keep <n> rotated files kept by the file sink (default 4)\n"
+         << "  --telemetry-ring <n>    ticks kept by the memory sink (default 64)\n"
+         << "  --influxdb-url <url>    database used by the influx sink and decision source (default " << INFLUXDB_URL << ")\n"
+         << "  --telemetry-policy <p>  what to do when the database writer falls behind: block (default), drop-oldest or coalesce\n"
+         << "  --telemetry-buffer <n>  number of tick snapshots that can wait for the database writer (default 8)\n"
+         << "  --telemetry-late <s>    seconds after which an unwritten tick counts as late (default 1)\n"
+         << "  --telemetry-mode <m>    full (default) writes every RU on every tick, changes only writes RUs whose state changed\n"
+         << "  --telemetry-heartbeat <n> in changes mode, also write each RU every n ticks (default 100)\n"
+         << "  --telemetry-total-every <n> write sim_total every n ticks (default 1)\n"
+         << "  --telemetry-encoding <e> text (default) writes uid lists like \"UE_1,UE_2,\", compact writes them as base64 varints\n"
+         << "  --trace-file <path>     write a binary trace of the run to path, see trace.h for its layout (default off)\n"
+         << "  --checkpoint-file <path> save checkpoints of the whole simulation state to path on SIGUSR1 (default off)\n"
+         << "  --checkpoint-every <n>  also save a checkpoint every n ticks (default 0, only on SIGUSR1)\n"
+         << "  --checkpoint-load <path> resume from a checkpoint, its topology, seed and traffic options replace the given ones\n"
+         << "  --record-file <path>    log UE arrivals and handover decisions with the tick that took them in, see event_log.h (default off)\n"
+         << "  --replay-file <path>    take UE arrivals and handover decisions from an event log instead, repeating the recorded run exactly\n"
+         << "  --decision-source <s>   socket (default) listens for handover decisions pushed by xApps, influx polls the database for them, none ignores xApps\n"
+         << "  --decision-address <ip> address to listen for handover decisions on, 0.0.0.0 for all interfaces (default 127.0.0.1)\n"
+         << "  --decision-port <n>     port to listen for handover decisions on (default 8087)\n"
+         << "  --macro-stride <n>      also exchange every n:th RU with a macro-RU (default 0, off)\n"
+         << "  --macro \"<i> <x> <y>\"   exchange RU i with a macro-RU at x, y (repeatable, \"none\" for no macro-RUs)" << endl;
+}
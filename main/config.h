@@ -0,0 +1,78 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "constants.h"
+#include "sim_clock.h"
+#include "telemetry.h"
+
+// Macro-RU that replaces the micro-RU at a given index of the grid
+struct MacroPlacement
+{
+    int ru_index;
+    float coords[2]; // x, y coords
+};
+
+// Where the simulation gets handover decisions from
+enum class DecisionSource
+{
+    socket, // pushed by xApps to a TCP port that the simulation listens on
+    influx, // polled from the handovers measurement of the database every tick
+    none    // no decisions, for running the simulation without xApps
+};
+
+/// @brief Simulation topology and run parameters, filled in from a scenario file and/or the command line before the simulation starts
+struct SimConfig
+{
+    int grid_size = GRID_SIZE;          // the length of one side of the grid of micro-RUs
+    int closest_rus = UE_CLOSEST_RUS;   // the number of nearby RUs that each UE keeps track of
+    float max_coord = 5000;             // the maximum x and y coordinate of the simulation map
+    float margin = 0.2;                 // how far from the edges the micro-RU grid should be (0.2 margin on 5000 max_coord means grid will stretch from 1000-4000)
+    int initial_ues = 80;               // number of UEs spawned before the simulation starts
+    long duration = 300;                // how long the simulation should last (in seconds)
+    unsigned int seed = 42;
+    ClockMode clock = ClockMode::realtime; // realtime paces the simulation after the wall clock, event runs it as fast as possible
+    float tick_interval = 0.01;         // simulation time between ticks (in seconds)
+    int threads = 1;                    // number of threads (and RU shards) processing each tick
+    int traffic_sources = 1;            // number of threads spawning UEs, each adding a UE every 0.3 - 0.6 seconds
+    std::string influxdb_url = INFLUXDB_URL; // database written to by the influx sink and polled by the influx decision source
+    TelemetrySinkType telemetry_sink = TelemetrySinkType::influx; // where the telemetry writer sends each tick
+    std::string telemetry_file = "telemetry.lp"; // file written by the file sink
+    long telemetry_file_bytes = 64 << 20; // size at which the file sink rotates its file
+    int telemetry_file_keep = 4;        // rotated files kept by the file sink, as telemetry_file.1 to telemetry_file.n
+    int telemetry_ring = 64;            // latest ticks kept by the memory sink
+    OverflowPolicy telemetry_policy = OverflowPolicy::block; // what to do with a tick when the database writer has fallen behind
+    int telemetry_buffer = 8;           // number of tick snapshots that can wait for the database writer at once
+    float telemetry_late = 1;           // seconds after which a tick that is still not written counts as late
+    TelemetryMode telemetry_mode = TelemetryMode::full; // write every RU on every tick, or only RUs that changed
+    int telemetry_heartbeat = 100;      // in changes mode, ticks after which an unchanged RU is written anyway
+    int telemetry_total_every = 1;      // sim_total is written every telemetry_total_every:th tick
+    TelemetryEncoding telemetry_encoding = TelemetryEncoding::text; // how connection lists and UE neighbor tables are written
+    std::string trace_file = "";        // binary trace of the run is written here if set, see trace.h for its layout
+    std::string checkpoint_file = "";   // checkpoints are saved here if set, on SIGUSR1 and every checkpoint_every ticks
+    long checkpoint_every = 0;          // ticks between checkpoints, 0 to only save them on SIGUSR1
+    std::string checkpoint_load = "";   // checkpoint to resume from instead of building a new network, see checkpoint.h
+    std::string record_file = "";       // UE arrivals and handover decisions are logged here if set, see event_log.h
+    std::string replay_file = "";       // event log to take UE arrivals and handover decisions from instead of traffic sources and xApps
+    DecisionSource decision_source = DecisionSource::socket;
+    std::string decision_address = "127.0.0.1"; // address the decision port is bound to, 0.0.0.0 to take decisions from other hosts
+    int decision_port = 8087;           // port that handover decisions are pushed to when decision_source is socket
+    int macro_stride = 0;               // if above 0, every macro_stride:th RU of the grid is also exchanged with a macro-RU at the same position
+    std::vector<MacroPlacement> macros = {{25, {2500, 1000}}, {50, {1000, 3500}}, {75, {4000, 3500}}};
+
+    const int num_rus() { return grid_size * grid_size; }
+};
+
+extern SimConfig sim_cfg;
+
+/// @brief Reads a scenario file of "key = value" lines into the config, lines starting with # or [ are ignored.
+/// Keys are the same as the SimConfig members, macro-RUs are given as "macro = <ru index> <x> <y>" (repeatable, the first one replaces
+/// the default macro-RUs) or "macro = none"
+/// @return true if the file could be read and all lines are valid, false otherwise
+bool load_scenario(SimConfig &cfg, const std::string &path);
+
+/// @brief Parses command line options into the config, see print_usage for the available options. A scenario file given
+/// with --scenario is loaded first, so that the other options can override it no matter their order
+/// @return true if all options are valid, false otherwise
+bool parse_args(SimConfig &cfg, int argc, char **argv);
+
+void print_usage(const char *program);
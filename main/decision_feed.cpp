@@ -0,0 +1,155 @@
+#include <charconv>
+#include <climits>
+#include <iostream>
+#include "decision_feed.h"
+#include "decision_intake.h"
+#include <InfluxDBFactory.h>
+
+using namespace std;
+
+bool NoDecisionFeed::start()
+{
+    return true;
+}
+
+void NoDecisionFeed::take(vector<PendingHandover> &)
+{
+}
+
+/// @brief Reads a uid like RU_61 at the start of str into id, moving str past it
+/// @param limit ids must be below this
+static bool parse_uid(string_view &str, string_view prefix, int &id, int limit = INT_MAX)
+{
+    if (str.substr(0, prefix.size()) != prefix)
+        return false;
+
+    const char *end = str.data() + str.size();
+    auto [next, error] = from_chars(str.data() + prefix.size(), end, id);
+    if (error != errc() || id < 0 || id >= limit)
+        return false;
+
+    str.remove_prefix(next - str.data());
+    return true;
+}
+
+/// @brief Moves str past a comma at its start
+static bool parse_comma(string_view &str)
+{
+    if (str.empty() || str[0] != ',')
+        return false;
+
+    str.remove_prefix(1);
+    return true;
+}
+
+/// @brief Parses a single decision like UE_5,RU_61,RU_52, nothing may follow it
+static bool parse_decision(string_view d, int num_rus, PendingHandover &h)
+{
+    return parse_uid(d, "UE_", h.ue_id) && parse_comma(d) && parse_uid(d, "RU_", h.from_RU, num_rus) && parse_comma(d) &&
+           parse_uid(d, "RU_", h.to_RU, num_rus) && d.empty();
+}
+
+int parse_decisions(string_view decisions, int num_rus, vector<PendingHandover> &out)
+{
+    int malformed = 0;
+
+    // each decision is separated by a colon, with a trailing colon after the last one
+    while (!decisions.empty())
+    {
+        size_t end = min(decisions.find(':'), decisions.size());
+        string_view d = decisions.substr(0, end);
+        decisions.remove_prefix(min(end + 1, decisions.size()));
+
+        // line endings and padding around a decision are tolerated, empty decisions are skipped
+        d.remove_prefix(min(d.find_first_not_of(" \t\r"), d.size()));
+        d.remove_suffix(d.size() - min(d.find_last_not_of(" \t\r") + 1, d.size()));
+        if (d.empty())
+            continue;
+
+        PendingHandover h;
+        if (parse_decision(d, num_rus, h))
+            out.push_back(h);
+        else
+            malformed++;
+    }
+
+    return malformed;
+}
+
+bool parse_handover_point(string_view fields, string_view &decisions, int &decision_no)
+{
+    size_t start = fields.find("decisions=");
+    size_t no = fields.find("decision_no=");
+    if (start == string_view::npos || no == string_view::npos)
+        return false;
+
+    // decisions run up to decision_no, or to the end of fields if it came first
+    start += 10;
+    decisions = fields.substr(start, (no > start) ? no - start : string_view::npos);
+    decisions.remove_suffix(decisions.size() - min(decisions.find_last_not_of(" ,\"") + 1, decisions.size()));
+    if (!decisions.empty() && decisions[0] == '"')
+        decisions.remove_prefix(1);
+
+    const char *end = fields.data() + fields.size();
+    return from_chars(fields.data() + no + 12, end, decision_no).ec == errc();
+}
+
+InfluxDecisionFeed::InfluxDecisionFeed(const string &url, int num_rus)
+{
+    this->url = url;
+    this->num_rus = num_rus;
+}
+
+InfluxDecisionFeed::~InfluxDecisionFeed()
+{
+}
+
+bool InfluxDecisionFeed::start()
+{
+    influxdb = influxdb::InfluxDBFactory::Get(url);
+    return influxdb != nullptr;
+}
+
+void InfluxDecisionFeed::take(vector<PendingHandover> &out)
+{
+    vector<influxdb::Point> handovers = influxdb->query("select * from handovers where decision_no > " + to_string(latest_decision_no));
+
+    for (auto &&h : handovers)
+    {
+        h.floatsPrecision = 0; // makes parsing decision_no simpler, as it is an integer and would otherwise show up as 1.00000000
+        fields.assign(h.getTags());
+        fields += h.getFields(); // for some reason influxDB thinks all fields with string values are tags
+
+        string_view decisions;
+        int decision_no;
+        if (!parse_handover_point(fields, decisions, decision_no))
+        {
+            cout << "Warning! Skipped handovers point without decisions or decision_no: " << fields << endl;
+            continue;
+        }
+
+        if (decision_no > latest_decision_no)
+        {
+            latest_decision_no = decision_no;
+            if (parse_decisions(decisions, num_rus, out) > 0)
+                cout << "Warning! Skipped malformed handover decisions in decision " << decision_no << ": " << decisions << endl;
+        }
+    }
+}
+
+unique_ptr<DecisionFeed> make_decision_feed(DecisionSource source, const string &address, int port, const string &url, int num_rus)
+{
+    switch (source)
+    {
+    case DecisionSource::socket:
+        return make_unique<DecisionIntake>(address, port, num_rus);
+
+    case DecisionSource::influx:
+        return make_unique<InfluxDecisionFeed>(url, num_rus);
+
+    case DecisionSource::none:
+        return make_unique<NoDecisionFeed>();
+    }
+
+    return nullptr; // should be unreachable
+}
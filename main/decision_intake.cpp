@@ -0,0 +1,139 @@
+#include <cstring>
+#include <iostream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "decision_intake.h"
+
+using namespace std;
+
+DecisionIntake::DecisionIntake(const string &address, int port, int num_rus)
+{
+    this->address = address;
+    this->port = port;
+    this->num_rus = num_rus;
+}
+
+bool DecisionIntake::start()
+{
+    listen_sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_sock < 0)
+        return false;
+
+    int reuse = 1;
+    setsockopt(listen_sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+
+    // decisions are taken from anyone who can connect, so only the interfaces asked for are listened on
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1 || bind(listen_sock, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_sock, 8) != 0)
+    {
+        close(listen_sock);
+        listen_sock = -1;
+        return false;
+    }
+
+    stopping = false;
+    listener = thread(&DecisionIntake::listen_loop, this);
+    return true;
+}
+
+void DecisionIntake::stop()
+{
+    if (!listener.joinable())
+        return;
+
+    stopping = true;
+    listener.join();
+    close(listen_sock);
+    listen_sock = -1;
+}
+
+void DecisionIntake::take(vector<PendingHandover> &out)
+{
+    lock_guard<std::mutex> lock(mutex);
+    out.insert(out.end(), queued.begin(), queued.end());
+    queued.clear();
+}
+
+const long DecisionIntake::get_received()
+{
+    lock_guard<std::mutex> lock(mutex);
+    return received;
+}
+
+void DecisionIntake::listen_loop()
+{
+    vector<pollfd> fds = {{listen_sock, POLLIN, 0}};
+    vector<string> partial_lines = {""}; // data received after the last newline of each connection, same index as fds
+    vector<PendingHandover> parsed;
+    char buf[4096];
+
+    while (!stopping)
+    {
+        // wakes up regularly to notice stop() being called
+        if (poll(fds.data(), fds.size(), 100) <= 0)
+            continue;
+
+        if (fds[0].revents & POLLIN)
+        {
+            int client = accept(listen_sock, nullptr, nullptr);
+            if (client >= 0)
+            {
+                fds.push_back({client, POLLIN, 0});
+                partial_lines.push_back("");
+            }
+        }
+
+        for (size_t i = fds.size() - 1; i > 0; i--)
+        {
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+
+            ssize_t got = recv(fds[i].fd, buf, sizeof(buf), 0);
+            if (got <= 0)
+            {
+                close(fds[i].fd);
+                fds.erase(fds.begin() + i);
+                partial_lines.erase(partial_lines.begin() + i);
+                continue;
+            }
+
+            // Parse every complete line, keeping the rest until more data arrives
+            string &line = partial_lines[i];
+            line.append(buf, got);
+            if (line.find('\n') == string::npos && line.size() > DECISION_LINE_MAX)
+            {
+                cout << "Warning! Dropped a decision connection that sent more than " << DECISION_LINE_MAX << " bytes without a line break" << endl;
+                close(fds[i].fd);
+                fds.erase(fds.begin() + i);
+                partial_lines.erase(partial_lines.begin() + i);
+                continue;
+            }
+
+            size_t start = 0, end;
+            long lines = 0;
+            while ((end = line.find('\n', start)) != string::npos)
+            {
+                string_view decisions = string_view(line).substr(start, end - start);
+                if (parse_decisions(decisions, num_rus, parsed) > 0)
+                    cout << "Warning! Skipped malformed handover decisions: " << decisions << endl;
+                start = end + 1;
+                lines++;
+            }
+            line.erase(0, start);
+
+            lock_guard<std::mutex> lock(mutex);
+            queued.insert(queued.end(), parsed.begin(), parsed.end());
+            received += lines;
+            parsed.clear();
+        }
+    }
+
+    for (size_t i = 1; i < fds.size(); i++)
+        close(fds[i].fd);
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "decision_feed.h"
+
+#define DECISION_LINE_MAX (1 << 20) // longest line of decisions accepted, a connection sending a longer one is dropped
+
+/// @brief TCP socket that xApps push handover decisions to, one line of decisions per message in the format taken by
+/// parse_decisions. A listener thread parses decisions as they arrive and queues them until the simulation takes them at
+/// the next tick boundary, so ticks never wait on the network
+class DecisionIntake : public DecisionFeed
+{
+private:
+    std::string address;
+    int port;
+    int num_rus;
+    int listen_sock = -1;
+    std::thread listener;
+    std::atomic<bool> stopping{false};
+    std::mutex mutex;
+    std::vector<PendingHandover> queued; // parsed decisions waiting for the next tick
+    long received = 0;                   // decision lines received in total
+
+    void listen_loop();
+
+public:
+    /// @param address IPv4 address to listen on, 0.0.0.0 for all interfaces
+    /// @param num_rus number of RUs in the simulation, decisions naming any other RU are skipped
+    DecisionIntake(const std::string &address, int port, int num_rus);
+
+    /// @brief Starts listening for connections on the address and port
+    /// @return false if the address is invalid or could not be bound
+    bool start() override;
+
+    /// @brief Closes the socket and all connections and stops the listener thread
+    void stop() override;
+
+    /// @brief Moves every decision received since the last call to out, in the order they were received
+    void take(std::vector<PendingHandover> &out) override;
+
+    const long get_received();
+};
@@ -0,0 +1,122 @@
+#include <iostream>
+#include "event_log.h"
+
+using namespace std;
+
+// ========================
+// EventLogWriter Functions
+// ========================
+
+bool EventLogWriter::open(const string &path, const EventLogHeader &header)
+{
+    opened = file.open(path, "wb");
+    file.put(header);
+    return opened && file.ok();
+}
+
+const bool EventLogWriter::is_open()
+{
+    return opened;
+}
+
+void EventLogWriter::write_tick(long tick_no, const vector<unique_ptr<Arrival>> &arrivals, const vector<PendingHandover> &decisions)
+{
+    if (!opened || (arrivals.empty() && decisions.empty()))
+        return;
+
+    logged.clear();
+    for (auto &&arrival : arrivals)
+        logged.push_back(LoggedArrival{arrival->t, arrival->lifetime, {arrival->coords[0], arrival->coords[1]}, arrival->ue_id, arrival->prb_demand});
+
+    file.put(EventLogTick{tick_no, (uint32_t)arrivals.size(), (uint32_t)decisions.size()});
+    file.put(logged);
+    file.put(decisions);
+}
+
+bool EventLogWriter::close()
+{
+    if (!opened)
+        return true;
+
+    file.close();
+    opened = false;
+    return file.ok();
+}
+
+// ========================
+// EventLogReader Functions
+// ========================
+
+bool EventLogReader::open(const string &path, EventLogHeader &header)
+{
+    has_next = false;
+    if (!file.open(path, "rb"))
+        return false;
+
+    file.get(header);
+    if (!file.ok() || memcmp(header.magic, EVENT_LOG_MAGIC, sizeof(header.magic)) != 0 || header.version != 1)
+    {
+        file.close();
+        return false;
+    }
+
+    read_block_header();
+    return true;
+}
+
+void EventLogReader::close()
+{
+    file.close();
+    has_next = false;
+}
+
+void EventLogReader::read_block_header()
+{
+    file.get(next);
+    has_next = file.ok();
+}
+
+void EventLogReader::take(long tick_no, vector<unique_ptr<Arrival>> &arrivals, vector<PendingHandover> &decisions)
+{
+    arrivals.clear();
+    decisions.clear();
+
+    while (has_next && next.tick_no <= tick_no)
+    {
+        file.get(logged, next.num_arrivals);
+        file.get(decisions, next.num_decisions);
+        if (!file.ok())
+        {
+            cout << "Warning! The last block of the event log is cut short, replaying no further inputs" << endl;
+            arrivals.clear();
+            decisions.clear();
+            has_next = false;
+            return;
+        }
+
+        // Blocks of ticks before the replay started were taken in before a restored checkpoint
+        if (next.tick_no == tick_no)
+        {
+            int k = sim_UEs.get_closest_rus();
+            for (size_t i = 0; i < logged.size(); i++)
+            {
+                unique_ptr<Arrival> arrival(new Arrival());
+                arrival->t = logged[i].t;
+                arrival->source = -1;
+                arrival->seq = i;
+                arrival->ue_id = logged[i].ue_id;
+                arrival->coords[0] = logged[i].coords[0];
+                arrival->coords[1] = logged[i].coords[1];
+                arrival->lifetime = logged[i].lifetime;
+                arrival->prb_demand = logged[i].prb_demand;
+                arrival->sig_arr.resize(k);
+                ru_grid.query(arrival->coords, arrival->sig_arr.data(), k);
+                arrivals.push_back(move(arrival));
+            }
+        }
+        else
+            decisions.clear();
+
+        read_block_header();
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "checkpoint.h"
+#include "sim.h"
+#include "traffic.h"
+
+// Log of every input the simulation gets from outside the simulation thread, i.e. UE arrivals from the traffic sources
+// and handover decisions from xApps, each stored with the tick that took it in. Replaying a log feeds the simulation the
+// same inputs at the same ticks, which makes the run repeat bit for bit regardless of thread timing, clock mode or xApps.
+// Values are stored in native byte order like checkpoints, the layout is:
+//
+// EventLogHeader
+// then one block per tick that took in any inputs, in tick order:
+//   EventLogTick
+//   LoggedArrival[num_arrivals]     in the order they were admitted
+//   PendingHandover[num_decisions]  in the order they were posted
+//
+// A block cut short by the simulation stopping is ignored
+
+#define EVENT_LOG_MAGIC "EEEVLOG1"
+
+struct EventLogHeader
+{
+    char magic[8];         // EVENT_LOG_MAGIC, without the terminating null
+    uint32_t version;      // 1
+    uint32_t num_rus;
+    uint32_t closest_rus;
+    uint32_t seed;
+    uint32_t initial_ues;
+    float tick_interval;
+    int64_t start_tick;    // tick the recorded run started after, 0 unless it was resumed from a checkpoint
+};
+
+struct EventLogTick
+{
+    int64_t tick_no;
+    uint32_t num_arrivals;
+    uint32_t num_decisions;
+};
+
+struct LoggedArrival
+{
+    double t;
+    double lifetime;
+    float coords[2];
+    int32_t ue_id;
+    int32_t prb_demand;
+};
+
+/// @brief Appends the inputs of each tick to an event log
+class EventLogWriter
+{
+private:
+    CheckpointFile file;
+    bool opened = false;
+    std::vector<LoggedArrival> logged; // reused between ticks
+
+public:
+    /// @brief Creates the log and writes its header
+    /// @return false if the file could not be created
+    bool open(const std::string &path, const EventLogHeader &header);
+    const bool is_open();
+
+    /// @brief Writes a block with the inputs of a tick, nothing is written for ticks without any
+    void write_tick(long tick_no, const std::vector<std::unique_ptr<Arrival>> &arrivals, const std::vector<PendingHandover> &decisions);
+
+    /// @return false if anything could not be written
+    bool close();
+};
+
+/// @brief Reads an event log through a memory mapping, handing out the inputs of each tick as the replayed run reaches it
+class EventLogReader
+{
+private:
+    CheckpointFile file;
+    EventLogTick next = {};  // next block to hand out, read ahead of its tick
+    bool has_next = false;
+    std::vector<LoggedArrival> logged; // reused between ticks
+
+    void read_block_header();
+
+public:
+    /// @return false if the file can't be read or isn't an event log
+    bool open(const std::string &path, EventLogHeader &header);
+    void close();
+
+    /// @brief Takes the arrivals and decisions logged for a tick, skipping blocks of earlier ticks. Arrivals get their
+    /// closest RUs looked up again through the ru_grid, as they were in the recorded run
+    void take(long tick_no, std::vector<std::unique_ptr<Arrival>> &arrivals, std::vector<PendingHandover> &decisions);
+};
@@ -0,0 +1,130 @@
+#include <charconv>
+#include "line_protocol.h"
+
+using namespace std;
+
+string LineEncoder::tag_set(string_view measurement, initializer_list<pair<string_view, string_view>> tags)
+{
+    LineEncoder encoder;
+    encoder.append_escaped(measurement, ", ");
+    for (auto &&tag : tags)
+    {
+        encoder.buf += ',';
+        encoder.append_escaped(tag.first, ",= ");
+        encoder.buf += '=';
+        encoder.append_escaped(tag.second, ",= ");
+    }
+    return encoder.buf;
+}
+
+void LineEncoder::append_escaped(string_view str, string_view special)
+{
+    for (char c : str)
+    {
+        if (special.find(c) != string_view::npos)
+            buf += '\\';
+        buf += c;
+    }
+}
+
+void LineEncoder::begin(const string &tag_set)
+{
+    buf += tag_set;
+    buf += ' ';
+    first_field = true;
+}
+
+void LineEncoder::begin(const string &tag_set, int tag_suffix)
+{
+    buf += tag_set;
+    append(tag_suffix);
+    buf += ' ';
+    first_field = true;
+}
+
+void LineEncoder::field_key(string_view key)
+{
+    if (!first_field)
+        buf += ',';
+    first_field = false;
+    append_escaped(key, ",= ");
+    buf += '=';
+}
+
+void LineEncoder::field(string_view key, int value)
+{
+    field_key(key);
+    append(value);
+    buf += 'i'; // integer field, otherwise influx would store it as a float
+}
+
+void LineEncoder::field(string_view key, float value)
+{
+    field_key(key);
+    char digits[32];
+    auto result = to_chars(digits, digits + sizeof(digits), value); // shortest representation that reads back as the same float
+    buf.append(digits, result.ptr);
+}
+
+void LineEncoder::field(string_view key, string_view value)
+{
+    begin_string_field(key);
+    append(value);
+    end_string_field();
+}
+
+void LineEncoder::begin_string_field(string_view key)
+{
+    field_key(key);
+    buf += '"';
+}
+
+void LineEncoder::append(string_view str)
+{
+    append_escaped(str, "\"\\");
+}
+
+void LineEncoder::append(int value)
+{
+    char digits[16];
+    auto result = to_chars(digits, digits + sizeof(digits), value);
+    buf.append(digits, result.ptr);
+}
+
+void LineEncoder::append(float value, int decimals)
+{
+    char digits[64];
+    auto result = to_chars(digits, digits + sizeof(digits), value, chars_format::fixed, decimals);
+    buf.append(digits, result.ptr);
+}
+
+void LineEncoder::end_string_field()
+{
+    buf += '"';
+}
+
+void LineEncoder::end(long long timestamp)
+{
+    buf += ' ';
+    char digits[24];
+    auto result = to_chars(digits, digits + sizeof(digits), timestamp);
+    buf.append(digits, result.ptr);
+    buf += '\n';
+    lines++;
+}
+
+const string &LineEncoder::data()
+{
+    return buf;
+}
+
+const int LineEncoder::get_lines()
+{
+    return lines;
+}
+
+void LineEncoder::clear()
+{
+    buf.clear();
+    lines = 0;
+}
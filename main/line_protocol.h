@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <utility>
+#include <initializer_list>
+
+/// @brief Encodes points in InfluxDB line protocol into a reusable buffer. Once the buffer has grown to fit a tick's worth
+/// of points, encoding does not allocate: tag sets are precomputed with tag_set and numbers are formatted with std::to_chars.
+/// A line is begun with begin, followed by one or more fields and finished with end
+class LineEncoder
+{
+private:
+    std::string buf;
+    int lines = 0;
+    bool first_field = true;
+
+    void field_key(std::string_view key);
+    void append_escaped(std::string_view str, std::string_view special);
+
+public:
+    /// @brief Builds the escaped "measurement,tag=value,..." prefix of a line, meant to be computed once and reused for every line
+    static std::string tag_set(std::string_view measurement, std::initializer_list<std::pair<std::string_view, std::string_view>> tags);
+
+    void begin(const std::string &tag_set);
+    /// @brief Begins a line whose last tag value is completed by a number, e.g. a tag set ending in "uid=UE_" and id 5 gives uid=UE_5
+    void begin(const std::string &tag_set, int tag_suffix);
+    void field(std::string_view key, int value);
+    void field(std::string_view key, float value);
+    void field(std::string_view key, std::string_view value);
+
+    /// @brief Starts a string field that is filled in piece by piece with the append functions, avoiding a temporary string
+    void begin_string_field(std::string_view key);
+    void append(std::string_view str);
+    void append(int value);
+    /// @brief Appends a float with a fixed number of decimals, like std::to_string does
+    void append(float value, int decimals);
+    void end_string_field();
+
+    /// @param timestamp nanoseconds since the epoch
+    void end(long long timestamp);
+
+    const std::string &data();
+    const int get_lines();
+
+    /// @brief Empties the buffer but keeps its capacity
+    void clear();
+};
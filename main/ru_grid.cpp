@@ -0,0 +1,204 @@
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+#include "ru_grid.h"
+#include "sim.h"
+#include "sig_kernel.h"
+
+using namespace std;
+
+void RUGrid::build(RU *rus, int num_rus, float cell_size)
+{
+    this->rus = rus;
+    this->max_range = 0;
+
+    // Find bounding box of all RUs
+    float min_c[2] = {INFINITY, INFINITY};
+    float max_c[2] = {-INFINITY, -INFINITY};
+    for (int i = 0; i < num_rus; i++)
+    {
+        const float *c = rus[i].get_coords();
+        for (int d = 0; d < 2; d++)
+        {
+            min_c[d] = min(min_c[d], c[d]);
+            max_c[d] = max(max_c[d], c[d]);
+        }
+        max_range = max(max_range, rus[i].get_range());
+    }
+
+    if (num_rus == 0)
+    {
+        min_c[0] = min_c[1] = max_c[0] = max_c[1] = 0;
+    }
+
+    // Aim for a handful of RUs per cell, but never use cells wider than the micro-RU range
+    if (cell_size <= 0)
+    {
+        float area = max((max_c[0] - min_c[0]) * (max_c[1] - min_c[1]), 1.0f);
+        cell_size = clamp(sqrtf(area * 4 / max(num_rus, 1)), 1.0f, 500.0f);
+    }
+
+    this->cell_size = cell_size;
+    this->origin[0] = min_c[0];
+    this->origin[1] = min_c[1];
+    this->cols = (int)((max_c[0] - min_c[0]) / cell_size) + 1;
+    this->rows = (int)((max_c[1] - min_c[1]) / cell_size) + 1;
+
+    // Counting sort of RU indices into cells
+    vector<int> ru_cell(num_rus);
+    cell_start.assign(cols * rows + 1, 0);
+    for (int i = 0; i < num_rus; i++)
+    {
+        const float *c = rus[i].get_coords();
+        int cx = min((int)((c[0] - origin[0]) / cell_size), cols - 1);
+        int cy = min((int)((c[1] - origin[1]) / cell_size), rows - 1);
+        ru_cell[i] = cy * cols + cx;
+        cell_start[ru_cell[i] + 1]++;
+    }
+
+    for (int c = 0; c < cols * rows; c++)
+        cell_start[c + 1] += cell_start[c];
+
+    ru_ids.resize(num_rus);
+    vector<int> fill(cell_start.begin(), cell_start.end() - 1);
+    for (int i = 0; i < num_rus; i++)
+        ru_ids[fill[ru_cell[i]]++] = i;
+
+    ru_x.resize(num_rus);
+    ru_y.resize(num_rus);
+    ru_range.resize(num_rus);
+    cell_range.assign(cols * rows, 0);
+    for (int j = 0; j < num_rus; j++)
+    {
+        RU &ru = rus[ru_ids[j]];
+        ru_x[j] = ru.get_coords()[0];
+        ru_y[j] = ru.get_coords()[1];
+        ru_range[j] = ru.get_range();
+    }
+
+    for (int i = 0; i < num_rus; i++)
+        cell_range[ru_cell[i]] = max(cell_range[ru_cell[i]], rus[i].get_range());
+}
+
+/// @brief Distance from coords to the closest point of the cell rectangle [x0, x1] x [y0, y1] (inclusive cell indices)
+float RUGrid::min_dist(const float coords[2], int x0, int y0, int x1, int y1)
+{
+    float dx = max({origin[0] + x0 * cell_size - coords[0], 0.0f, coords[0] - (origin[0] + (x1 + 1) * cell_size)});
+    float dy = max({origin[1] + y0 * cell_size - coords[1], 0.0f, coords[1] - (origin[1] + (y1 + 1) * cell_size)});
+    return sqrtf(dx * dx + dy * dy);
+}
+
+/// @brief Whether cell x, y is empty or too far away to hold anything better than the k candidates already found
+bool RUGrid::can_skip(const float coords[2], int x, int y, RU_entry *out, int found, int k)
+{
+    int cell = y * cols + x;
+    return cell_start[cell] == cell_start[cell + 1] ||
+           (found == k && clamp(1 - min_dist(coords, x, y, x, y) / cell_range[cell], 0.0f, 1.0f) <= out[k - 1].sig_str);
+}
+
+int RUGrid::query(const float coords[2], RU_entry *out, int k)
+{
+    switch (k)
+    {
+    case 4:
+        return search(coords, out, integral_constant<int, 4>());
+    case 8:
+        return search(coords, out, integral_constant<int, 8>());
+    case 10:
+        return search(coords, out, integral_constant<int, 10>());
+    case 16:
+        return search(coords, out, integral_constant<int, 16>());
+    default:
+        return search(coords, out, k);
+    }
+}
+
+static const int SCORE_BLOCK = 64; // RUs scored per kernel call, bounds the stack buffer
+
+template <typename KType>
+int RUGrid::search(const float coords[2], RU_entry *out, KType k)
+{
+    int found = 0;
+    if (k <= 0 || ru_ids.empty())
+        return 0;
+
+    // Start in the cell closest to the coords, which may lie outside of the grid
+    int cx = clamp((int)floorf((coords[0] - origin[0]) / cell_size), 0, cols - 1);
+    int cy = clamp((int)floorf((coords[1] - origin[1]) / cell_size), 0, rows - 1);
+
+    // Best signal strength any RU at distance dist could have
+    auto sig_bound = [this](float dist)
+    { return clamp(1 - dist / max_range, 0.0f, 1.0f); };
+
+    for (int r = 0;; r++)
+    {
+        // Visit every cell at chebyshev distance r from the start cell. Cells next to each other in a row also have their
+        // RUs next to each other, so each row is handled as a single span of RUs (or two, left and right side of the ring)
+        for (int y = cy - r; y <= cy + r; y++)
+        {
+            if (y < 0 || y >= rows)
+                continue;
+
+            bool edge_row = (y == cy - r || y == cy + r);
+            int spans[2][2] = {{cx - r, edge_row ? cx + r : cx - r}, {cx + r, cx + r}};
+            for (int s = 0; s < (edge_row ? 1 : 2); s++)
+            {
+                int x0 = max(spans[s][0], 0), x1 = min(spans[s][1], cols - 1);
+
+                // Trim cells that cannot hold anything better than what has already been found off both ends of the span
+                while (x0 <= x1 && can_skip(coords, x0, y, out, found, k))
+                    x0++;
+                while (x0 <= x1 && can_skip(coords, x1, y, out, found, k))
+                    x1--;
+                if (x0 > x1)
+                    continue;
+
+                // Score the span in blocks, then merge each block into the candidate list
+                int end = cell_start[y * cols + x1 + 1];
+                for (int j = cell_start[y * cols + x0]; j < end; j += SCORE_BLOCK)
+                {
+                    int n = min(SCORE_BLOCK, end - j);
+                    float sig_strs[SCORE_BLOCK];
+                    score_rus(coords, &ru_x[j], &ru_y[j], &ru_range[j], n, sig_strs);
+
+                    for (int b = 0; b < n; b++)
+                    {
+                        float sig_str = sig_strs[b];
+                        if (found == k && sig_str <= out[k - 1].sig_str)
+                            continue;
+
+                        // Insertion into the sorted candidate list, dropping the weakest entry if full
+                        int pos = (found < k) ? found++ : k - 1;
+                        while (pos > 0 && out[pos - 1].sig_str < sig_str)
+                        {
+                            out[pos] = out[pos - 1];
+                            pos--;
+                        }
+                        out[pos] = RU_entry(ru_ids[j + b], sig_str);
+                    }
+                }
+            }
+        }
+
+        // Searched box so far, clipped to the grid
+        int x0 = max(cx - r, 0), x1 = min(cx + r, cols - 1);
+        int y0 = max(cy - r, 0), y1 = min(cy + r, rows - 1);
+        if (x0 == 0 && y0 == 0 && x1 == cols - 1 && y1 == rows - 1)
+            break; // whole grid visited
+
+        if (found < k)
+            continue;
+
+        // Stop once no unvisited cell (the strips left, right, below and above the searched box) can beat the weakest candidate
+        float dist = INFINITY;
+        if (x0 > 0) dist = min(dist, min_dist(coords, 0, 0, x0 - 1, rows - 1));
+        if (x1 < cols - 1) dist = min(dist, min_dist(coords, x1 + 1, 0, cols - 1, rows - 1));
+        if (y0 > 0) dist = min(dist, min_dist(coords, x0, 0, x1, y0 - 1));
+        if (y1 < rows - 1) dist = min(dist, min_dist(coords, x0, y1 + 1, x1, rows - 1));
+
+        if (sig_bound(dist) <= out[k - 1].sig_str)
+            break;
+    }
+
+    return found;
+}
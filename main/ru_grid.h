@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+#include "components.h"
+
+/// @brief Uniform grid over RU coordinates, used to look up the strongest RUs around a point without scanning every RU
+class RUGrid
+{
+private:
+    RU *rus = nullptr;
+    float origin[2] = {0, 0};    // lower left corner of the grid
+    float cell_size = 500;       // side length of one cell, measured in meters
+    int cols = 0;
+    int rows = 0;
+    float max_range = 0;         // longest signal range of any indexed RU
+    std::vector<int> cell_start; // RUs of cell c are ru_ids[cell_start[c]] .. ru_ids[cell_start[c + 1] - 1]
+    std::vector<int> ru_ids;     // RU indices, ordered by cell
+    std::vector<float> ru_x;     // structure-of-arrays copy of RU coords and ranges, in the same order as ru_ids,
+    std::vector<float> ru_y;     // so that a row of cells can be scored by the batched kernel in one go
+    std::vector<float> ru_range;
+    std::vector<float> cell_range; // longest signal range of any RU in each cell, lets cells of micro-RUs be skipped sooner
+
+    float min_dist(const float coords[2], int x0, int y0, int x1, int y1);
+    bool can_skip(const float coords[2], int x, int y, RU_entry *out, int found, int k);
+
+    // KType is either int or std::integral_constant, the latter letting the compiler unroll the candidate list handling for common k
+    template <typename KType>
+    int search(const float coords[2], RU_entry *out, KType k);
+
+public:
+    /// @brief (Re)builds the grid, must be called again if RUs are moved or exchanged
+    /// @param rus the RU array to index, needs to outlive the grid
+    /// @param num_rus the number of RUs in the array
+    /// @param cell_size side length of a grid cell, or 0 to derive it from the RU density (capped at the micro-RU range)
+    void build(RU *rus, int num_rus, float cell_size = 0);
+
+    /// @brief Finds the k RUs with the strongest signal at the given coordinates, searching outwards from the closest cell.
+    /// Has specialized versions for k = 4, 8, 10 and 16
+    /// @param coords the x, y coords to measure signal strength from
+    /// @param out array of at least k entries, filled with the strongest RUs in descending order of signal strength
+    /// @param k the number of RUs to find
+    /// @return the number of entries written to out, less than k only if fewer than k RUs are indexed
+    int query(const float coords[2], RU_entry *out, int k);
+};
@@ -0,0 +1,87 @@
+#include "shard_pool.h"
+
+using namespace std;
+
+ShardPool::ShardPool(int num_shards)
+{
+    for (int shard = 1; shard < num_shards; shard++)
+        workers.emplace_back(&ShardPool::work, this, shard);
+}
+
+ShardPool::~ShardPool()
+{
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    job_ready.notify_all();
+
+    for (auto &&worker : workers)
+        worker.join();
+}
+
+const int ShardPool::size()
+{
+    return workers.size() + 1;
+}
+
+void ShardPool::work(int shard)
+{
+    long done_generation = 0;
+
+    while (true)
+    {
+        {
+            unique_lock<std::mutex> lock(mutex);
+            job_ready.wait(lock, [&]
+                           { return stopping || generation != done_generation; });
+            if (stopping) return;
+            done_generation = generation;
+        }
+
+        job(shard);
+
+        {
+            lock_guard<std::mutex> lock(mutex);
+            pending--;
+        }
+        job_done.notify_one();
+    }
+}
+
+void ShardPool::run(const function<void(int)> &job)
+{
+    if (workers.empty())
+    {
+        job(0);
+        return;
+    }
+
+    {
+        lock_guard<std::mutex> lock(mutex);
+        this->job = job;
+        pending = workers.size();
+        generation++;
+    }
+    job_ready.notify_all();
+
+    job(0);
+
+    unique_lock<std::mutex> lock(mutex);
+    job_done.wait(lock, [&]
+                  { return pending == 0; });
+}
+
+const int ShardPool::shard_begin(int shard, int n)
+{
+    return (long)n * shard / size();
+}
+
+const int ShardPool::shard_of(int i, int n)
+{
+    // inverse of shard_begin, adjusted for rounding
+    int shard = (long)i * size() / n;
+    while (shard + 1 < size() && shard_begin(shard + 1, n) <= i) shard++;
+    while (shard > 0 && shard_begin(shard, n) > i) shard--;
+    return shard;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+
+/// @brief Fixed pool of worker threads that runs one job per shard and waits for all of them to finish, which acts as
+/// a barrier between the phases of a tick. Shard 0 runs on the calling thread, so a pool of 1 shard runs everything inline
+class ShardPool
+{
+private:
+    std::vector<std::thread> workers; // worker i runs shard i + 1
+    std::function<void(int)> job;
+    std::mutex mutex;
+    std::condition_variable job_ready;
+    std::condition_variable job_done;
+    long generation = 0; // increased for every job, lets workers tell a new job from the one they just finished
+    int pending = 0;     // workers still running the current job
+    bool stopping = false;
+
+    void work(int shard);
+
+public:
+    explicit ShardPool(int num_shards);
+    ~ShardPool();
+
+    const int size();
+
+    /// @brief Runs job(shard) for every shard in parallel and returns once all of them are done
+    void run(const std::function<void(int)> &job);
+
+    /// @brief Splits n items into contiguous, evenly sized ranges, one per shard
+    /// @return the first item of the shard, the shard's items end where the next shard's begin
+    const int shard_begin(int shard, int n);
+
+    /// @brief Finds the shard that owns item i out of n
+    const int shard_of(int i, int n);
+};
@@ -0,0 +1,53 @@
+#include "sig_kernel.h"
+
+// GCC would otherwise fuse the multiplies and the add below into FMAs on targets that have them, intrinsics included,
+// see sig_kernel.h
+#pragma GCC optimize("fp-contract=off")
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Every lane does the same sub, mul, add, sqrt, div and clamp as sig_str_at, all of which are correctly rounded in IEEE
+// single precision, so the vector and scalar paths agree to the last bit. That only holds with neither of them
+// contracted into FMAs, hence the pragma above and the one around sig_str_at
+void score_rus(const float coords[2], const float *x, const float *y, const float *range, int n, float *out)
+{
+    int i = 0;
+
+#if defined(__AVX2__)
+    const __m256 ux8 = _mm256_set1_ps(coords[0]);
+    const __m256 uy8 = _mm256_set1_ps(coords[1]);
+    const __m256 zero8 = _mm256_setzero_ps();
+    const __m256 one8 = _mm256_set1_ps(1.0f);
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + i), ux8);
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y + i), uy8);
+        __m256 dist = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+        __m256 sig = _mm256_sub_ps(one8, _mm256_div_ps(dist, _mm256_loadu_ps(range + i)));
+        _mm256_storeu_ps(out + i, _mm256_min_ps(_mm256_max_ps(sig, zero8), one8));
+    }
+#endif
+
+#if defined(__SSE2__)
+    const __m128 ux4 = _mm_set1_ps(coords[0]);
+    const __m128 uy4 = _mm_set1_ps(coords[1]);
+    const __m128 zero4 = _mm_setzero_ps();
+    const __m128 one4 = _mm_set1_ps(1.0f);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), ux4);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), uy4);
+        __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+        __m128 sig = _mm_sub_ps(one4, _mm_div_ps(dist, _mm_loadu_ps(range + i)));
+        _mm_storeu_ps(out + i, _mm_min_ps(_mm_max_ps(sig, zero4), one4));
+    }
+#endif
+
+    // Scalar fallback, and the tail of the vectorized loops
+    for (; i < n; i++)
+        out[i] = sig_str_at(x[i] - coords[0], y[i] - coords[1], range[i]);
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+// GCC contracts a * b + c into a fused multiply-add in C++ whenever the target has FMA (e.g. -march=native), whatever
+// the -std, which rounds once instead of twice. Contraction is turned off for sig_str_at here and for score_rus in
+// sig_kernel.cpp, so neither depends on how the rest of the program is built. GCC doesn't inline a function built with
+// other fp-contract settings into its caller, so callers that allow contraction call sig_str_at out of line
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+
+/// @brief Signal strength at distance sqrt(dx^2 + dy^2) from an RU with the given range, clamped to 0 - 1.
+/// The batched kernel produces bit-identical results, so scalar and vectorized paths can be mixed freely
+inline float sig_str_at(float dx, float dy, float range)
+{
+    float dist = sqrtf(dx * dx + dy * dy);
+    return std::clamp(1 - dist / range, 0.0f, 1.0f);
+}
+
+#pragma GCC pop_options
+
+/// @brief Scores the signal strength from one point to a block of RUs stored as structure-of-arrays, using AVX2 or SSE2
+/// when the build targets them (e.g. -mavx2 or -march=native) and a scalar loop otherwise
+/// @param coords the x, y coords to measure signal strength from
+/// @param x x coordinate of each RU
+/// @param y y coordinate of each RU
+/// @param range signal range of each RU, 2000 meters for macro-RUs and 500 for micro-RUs
+/// @param n the number of RUs in the block
+/// @param out array of at least n entries, receives the signal strength of each RU
+void score_rus(const float coords[2], const float *x, const float *y, const float *range, int n, float *out);
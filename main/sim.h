@@ -1,57 +1,110 @@
 #pragma once
-#include <list>
-#include <atomic>
+#include <vector>
+#include <random>
 #include <iostream>
-#include "constants.h"
+#include "config.h"
 #include "components.h"
+#include "ru_grid.h"
+#include "shard_pool.h"
 
-extern RU sim_RUs[RU_NUM];
-extern std::list<UE> sim_UEs;
-extern std::list<UE> RU_conn[]; // Array of lists, one list for each RU that keeps track of all UEs connected to it
+extern std::vector<RU> sim_RUs;
+extern RUGrid ru_grid; // spatial index over sim_RUs, used by find_closest_rus
+extern UEStore sim_UEs;
+extern std::vector<std::vector<UEHandle>> RU_conn; // One list of handles for each RU that keeps track of all UEs connected to it
+
+extern std::default_random_engine rng;
+extern std::normal_distribution<float> coord_distribution; // distribution of UE x and y coords
+extern int i_ue;                                           // id of the next UE to be created
 
 /// @brief Prints all UEs connected to a given RU
 /// @param ru_index The RUs index in the sim_RUs array
 void print_ue_conn(int ru_index);
 
+/// @brief Resets the load accounting of all RUs to no connected UEs, must be called once RUs are placed and before any UE is attached
+void init_loads();
+
+/// @brief Connects a UE to an RU by appending it to the RU's RU_conn list, and adds its demand to the RU's load
+/// @param ue the UE to connect, must not already be connected
+/// @param ru_index the RU to connect to
+void attach_ue(UEHandle ue, int ru_index);
+
+/// @brief Disconnects a UE from its RU in constant time, by moving the last UE of the RU's RU_conn list into its place,
+/// and removes its demand from the RU's load
+/// @param ue the UE to disconnect, nothing happens if it isn't connected
+void detach_ue(UEHandle ue);
+
+/// @brief Changes the PRB demand of a UE, updating the load of its RU
+void set_ue_demand(UEHandle ue, int prb_demand);
+
 /// @brief Simulates a UE handover by moving a UE from one RU to another in the RU_conn array
-/// @param ue_uid the uid of the UE to be moved
+/// @param ue_id the numeric part of the uid of the UE to be moved
 /// @param from_RU the RU that currently holds the UE
 /// @param to_RU the RU that the UE should be moved to
 /// @return true if handover is successful, false otherwise
-bool handover(std::string ue_uid, int from_RU, int to_RU);
+bool handover(int ue_id, int from_RU, int to_RU);
 
-/// @brief Removes a UE from the simulation
+/// @brief Removes a UE from the simulation, disconnecting it from its RU if connected
 /// @param ue the ue that should be removed
-/// @param ru_index the ru that the UE is currently connected to
-void remove_ue(UE *ue, int ru_index);
+void remove_ue(UEHandle ue);
 
-bool sim_running();
-void lock_ue_mutex();
-void unlock_ue_mutex();
+/// @brief Calculates the signal strength of an RU at the given coordinates
+/// @param ru the RU to measure
+/// @param coords the x, y coords to measure at
+/// @return signal strength between 0 and 1, where 0 means out of range
+float calc_sig_str(RU &ru, const float coords[2]);
 
-float calc_sig_str(RU ru, UE ue);
+// Handover waiting in a mailbox to be applied at the next tick barrier
+struct PendingHandover
+{
+    int ue_id;
+    int from_RU;
+    int to_RU;
+};
 
-/// @brief Calculates the number of PRBs allocated to UEs for a given RU
-/// @param ru_index the index of the RU in the sim_RUs array
-/// @return the number of allocated PRBs, will return 0 if no UEs are connected
-int calc_alloc_PRB(int ru_index);
-
-/// @brief Offloads an RU of the last connected UE to its nearest or otherwise second nearest RU
+/// @brief Picks UEs to hand over from an overloaded RU, each to the RU with the best signal among its closest RUs that has
+/// enough free PRBs. The handovers are posted to a mailbox rather than executed, so the PRBs of the UEs planned for each
+/// target are reserved for the rest of the call, on top of the target's load before any of the planned handovers. Offloads
+/// planned by other calls can still pick the same target, which is checked again when the mailboxes are applied
 /// @param ru_index the RU to offload
-/// @return the number of PRBs freed
-int offload_ru(int ru_index);
+/// @param alloc_PRB the RU's current PRB demand
+/// @param mailbox where to post the planned handovers
+/// @return the RU's PRB demand once the planned handovers are done
+int plan_offloads(int ru_index, int alloc_PRB, std::vector<PendingHandover> &mailbox);
+
+/// @brief Queues a handover in the mailbox of the shard owning its from_RU, to be executed at the start of the next tick
+void post_handover(PendingHandover h);
 
-/// @brief Finds the n closest RUs to a given UE, and inserts these into the UE's sig_arr
+/// @brief Finds the n closest RUs to a given UE through the ru_grid, and inserts these into the UE's sig_arr
 /// @param ue the ue to find RUs and replace sig_arr of
-/// @return Returns the closest RU, since that is probably the most interesting one
-std::string find_closest_rus(UE *ue);
+/// @return Returns the index of the closest RU, since that is probably the most interesting one
+int find_closest_rus(UEHandle ue);
 
-std::string stringify_connected_ues(int ru_index);
+/// @brief Lists the UEs connected to an RU as "UE_1,UE_2,...,", or as a compact id set with telemetry_encoding = compact,
+/// reusing the capacity of out
+void stringify_connected_ues(int ru_index, std::string &out);
 
 /// @brief Stringifies signal strength array in order to update database
 /// @param ue The UE to stringify the array of
 /// @param dist If false, returns a string containing the UID's of each of the closest RUs. If true, returns the signal strengths to each of the closest RUs
 /// @return A string dependent on the value of the dist bool.
-std::string stringify_sig_str_arr(UE *ue, bool dist = false);
+std::string stringify_sig_str_arr(UEHandle ue, bool dist = false);
+
+/// @brief Creates a new UE at a random position and finds its closest RUs, without connecting it
+/// @return the handle of the new UE
+UEHandle create_ue();
+
+/// @brief Connects a UE to the RU with the strongest signal among its closest RUs that has enough free PRBs for its demand
+/// @return true if the UE was connected, false if none of its closest RUs had capacity for it
+bool connect_ue(UEHandle ue);
+
+/// @brief Runs the simulation on the sim_clock, processing ticks in time order while traffic source threads spawn new UEs,
+/// or while UEs and handover decisions are replayed from an event log (see event_log.h)
+/// @param sim_dur simulation time to run until, in seconds, also when resuming from a checkpoint
+/// @return false if the event log to replay can't be used
+bool sim_loop(long sim_dur);
 
-void sim_loop(int sim_dur);
\ No newline at end of file
+/// @brief Replaces RUs, UEs, connections, energy totals, pending events and the random engine with the contents of a
+/// checkpoint (see checkpoint.h), so that sim_loop continues from it. Topology, seed and traffic options are taken from
+/// the checkpoint. The RU grid index has to be rebuilt afterwards
+/// @return false if the checkpoint can't be read
+bool restore_checkpoint(const std::string &path);
\ No newline at end of file
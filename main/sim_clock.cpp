@@ -0,0 +1,92 @@
+#include <thread>
+#include "sim_clock.h"
+
+using namespace std;
+using namespace chrono;
+
+SimClock sim_clock;
+
+// ==================
+// SimClock Functions
+// ==================
+
+void SimClock::start(ClockMode mode, double t)
+{
+    this->mode = mode;
+    this->t = t;
+    this->wall_start = steady_clock::now() - duration_cast<steady_clock::duration>(duration<double>(t));
+}
+
+const double SimClock::now()
+{
+    return this->t;
+}
+
+const ClockMode SimClock::get_mode()
+{
+    return this->mode;
+}
+
+void SimClock::advance_to(double t)
+{
+    if (t <= this->t) return;
+
+    if (this->mode == ClockMode::realtime)
+        wait_until(t);
+
+    this->t = t;
+}
+
+void SimClock::wait_until(double t)
+{
+    this_thread::sleep_until(wall_start + duration_cast<steady_clock::duration>(duration<double>(t)));
+}
+
+// ====================
+// EventQueue Functions
+// ====================
+
+void EventQueue::schedule(double t, EventType type)
+{
+    events.push(SimEvent{t, next_seq++, type});
+}
+
+const bool EventQueue::empty()
+{
+    return events.empty();
+}
+
+const double EventQueue::next_time()
+{
+    return events.top().t;
+}
+
+SimEvent EventQueue::pop()
+{
+    SimEvent e = events.top();
+    events.pop();
+    return e;
+}
+
+const vector<SimEvent> EventQueue::get_pending()
+{
+    vector<SimEvent> pending;
+    auto copy = events;
+    while (!copy.empty())
+    {
+        pending.push_back(copy.top());
+        copy.pop();
+    }
+    return pending;
+}
+
+const long EventQueue::get_next_seq()
+{
+    return next_seq;
+}
+
+void EventQueue::restore(const vector<SimEvent> &pending, long next_seq)
+{
+    events = decltype(events)(pending.begin(), pending.end());
+    this->next_seq = next_seq;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <queue>
+#include <vector>
+
+enum class ClockMode
+{
+    realtime, // simulation time follows the wall clock, sleeping between events
+    event     // simulation time jumps straight to the next event, running as fast as possible
+};
+
+/// @brief Simulation clock that the whole model reads its time from, measured in seconds since the simulation started.
+/// Only the simulation thread advances the clock, other threads may read it
+class SimClock
+{
+private:
+    std::atomic<double> t{0};
+    ClockMode mode = ClockMode::realtime;
+    std::chrono::steady_clock::time_point wall_start;
+
+public:
+    /// @param t simulation time to start from, e.g. the time of a restored checkpoint
+    void start(ClockMode mode, double t = 0);
+    const double now();
+    const ClockMode get_mode();
+
+    /// @brief Moves the clock forward to time t, in realtime mode this sleeps until the wall clock has caught up
+    void advance_to(double t);
+
+    /// @brief Sleeps until the wall clock reaches simulation time t, for threads that pace themselves after the clock in realtime mode
+    void wait_until(double t);
+};
+
+enum class EventType
+{
+    tick,     // periodic simulation step: arrivals, expiries, telemetry and handovers
+    rebalance // offloads RUs that have become overloaded
+};
+
+struct SimEvent
+{
+    double t;      // simulation time at which the event happens
+    long seq;      // scheduling order, breaks ties between events at the same time so that runs are reproducible
+    EventType type;
+
+    bool operator>(SimEvent const &e) const
+    {
+        return (t > e.t) || (t == e.t && seq > e.seq);
+    }
+};
+
+/// @brief Queue of pending events, ordered by time and then by scheduling order
+class EventQueue
+{
+private:
+    std::priority_queue<SimEvent, std::vector<SimEvent>, std::greater<SimEvent>> events;
+    long next_seq = 0;
+
+public:
+    void schedule(double t, EventType type);
+    const bool empty();
+    const double next_time();
+    SimEvent pop();
+
+    /// @brief Copies the pending events, in the order they will be popped
+    const std::vector<SimEvent> get_pending();
+    const long get_next_seq();
+
+    /// @brief Replaces the pending events, e.g. with those of a restored checkpoint
+    void restore(const std::vector<SimEvent> &pending, long next_seq);
+};
+
+extern SimClock sim_clock;
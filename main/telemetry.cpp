@@ -0,0 +1,315 @@
+#include <iostream>
+#include "telemetry.h"
+#include "compact_codec.h"
+
+using namespace std;
+
+void RUSampleFilter::start(TelemetryMode mode, int heartbeat, int num_rus)
+{
+    this->mode = mode;
+    this->heartbeat = max(heartbeat, 1);
+    written.assign(num_rus, RUSample{-1, -1, -1, -1, -1, ""}); // nothing matches, so every RU is written on the first tick
+    due.assign(num_rus, false);
+    merged.resize(num_rus);
+    resend = false;
+}
+
+void RUSampleFilter::resend_all()
+{
+    resend = true;
+}
+
+void RUSampleFilter::check(const RUSample &sample, long tick_no, bool maybe_changed)
+{
+    int i = sample.ru;
+    RUSample &last = written[i];
+
+    due[i] = mode == TelemetryMode::full || resend || (tick_no + i) % heartbeat == 0 ||
+             (maybe_changed && (sample.free_PRB != last.free_PRB || sample.current_load != last.current_load ||
+                                sample.p != last.p || sample.connections != last.connections));
+
+    if (due[i] && mode == TelemetryMode::changes)
+        last = sample;
+}
+
+void RUSampleFilter::fill(TickSnapshot *snapshot, const vector<RUSample> &samples)
+{
+    vector<RUSample> &rus = snapshot->coalesced ? merged : snapshot->rus;
+    if (rus.size() < samples.size())
+        rus.resize(samples.size());
+
+    // Both the RUs already in a coalesced snapshot and the due RUs are ordered by RU index, where both have an RU the
+    // newer sample replaces the older one
+    int n = 0;
+    int old = 0;
+    int num_old = snapshot->coalesced ? snapshot->num_rus : 0;
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        if (!due[i])
+            continue;
+
+        while (old < num_old && snapshot->rus[old].ru < (int)i)
+            rus[n++] = snapshot->rus[old++];
+        if (old < num_old && snapshot->rus[old].ru == (int)i)
+            old++;
+        rus[n++] = samples[i];
+    }
+    while (old < num_old)
+        rus[n++] = snapshot->rus[old++];
+
+    if (snapshot->coalesced)
+        snapshot->rus.swap(merged); // merged keeps the old buffer, so neither has to grow again
+    snapshot->num_rus = n;
+    resend = false;
+}
+
+void TelemetryWriter::start(unique_ptr<TelemetrySink> sink, OverflowPolicy policy, int num_slots, double late_after, vector<RU> &rus, int closest_rus,
+                            TelemetryEncoding encoding)
+{
+    this->sink = move(sink);
+    this->policy = policy;
+    this->encoding = encoding;
+    this->late_after = chrono::duration<double>(late_after);
+    this->closest_rus = closest_rus;
+    this->stopping = false;
+    this->written = this->failed = this->dropped = this->coalesced = this->late = this->bytes = 0;
+
+    // RU names never change, so they are copied once instead of being read from the RUs while the simulation runs
+    ru_uids.clear();
+    ru_tags.clear();
+    for (auto &&ru : rus)
+    {
+        ru_uids.push_back(ru.get_UID());
+        ru_tags.push_back(LineEncoder::tag_set("sim_RUs", {{"uid", ru.get_UID()}, {"RU_type", ru.get_type_string()}}));
+    }
+    ue_tags = LineEncoder::tag_set("sim_UEs", {{"uid", "UE_"}});
+    total_tags = LineEncoder::tag_set("sim_total", {});
+
+    slots.assign(max(num_slots, 2), TickSnapshot());
+    free_slots.clear();
+    queued.clear();
+    for (int i = slots.size() - 1; i >= 0; i--)
+        free_slots.push_back(i);
+
+    writer = thread(&TelemetryWriter::work, this);
+}
+
+void TelemetryWriter::stop()
+{
+    if (!writer.joinable())
+        return;
+
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    slot_queued.notify_one();
+    writer.join();
+
+    cout << "Telemetry: " << written << " ticks written (" << bytes << " bytes), " << failed << " failed, " << dropped << " dropped, " << coalesced << " coalesced, "
+         << late << " late" << endl;
+}
+
+TickSnapshot *TelemetryWriter::acquire()
+{
+    unique_lock<std::mutex> lock(mutex);
+
+    // The writer holds at most one slot and the simulation none, so with at least 2 slots there is always a queued one
+    // to fall back on when no slot is free
+    if (free_slots.empty() && policy == OverflowPolicy::block)
+        slot_freed.wait(lock, [this]
+                        { return !free_slots.empty(); });
+
+    TickSnapshot *snapshot;
+    bool dropping = false;
+    if (!free_slots.empty())
+    {
+        snapshot = &slots[free_slots.back()];
+        free_slots.pop_back();
+    }
+    else if (policy == OverflowPolicy::drop_oldest)
+    {
+        snapshot = &slots[queued.front()];
+        queued.pop_front();
+        dropped++;
+        dropping = true;
+    }
+    else
+    {
+        // coalesce, the newest snapshot is taken back out of the queue and published again once the new tick is merged into it
+        snapshot = &slots[queued.back()];
+        queued.pop_back();
+        coalesced++;
+        snapshot->coalesced = true;
+        return snapshot;
+    }
+
+    snapshot->ues.clear();
+    snapshot->ue_sig_arrs.clear();
+    snapshot->num_rus = 0;
+    snapshot->coalesced = false;
+    snapshot->dropped = dropping;
+    snapshot->write_total = false;
+    return snapshot;
+}
+
+void TelemetryWriter::publish(TickSnapshot *snapshot)
+{
+    snapshot->taken = chrono::steady_clock::now();
+    snapshot->timestamp = chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    {
+        lock_guard<std::mutex> lock(mutex);
+        queued.push_back(snapshot - slots.data());
+    }
+    slot_queued.notify_one();
+}
+
+void TelemetryWriter::work()
+{
+    unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        slot_queued.wait(lock, [this]
+                         { return stopping || !queued.empty(); });
+        if (queued.empty())
+            break; // stopping, and everything has been written
+
+        int slot = queued.front();
+        queued.pop_front();
+
+        // the slot is neither free nor queued while it is written, so the simulation can't touch it
+        lock.unlock();
+        encode(slots[slot]);
+        bool ok = sink->write(encoder.data());
+        bool was_late = chrono::steady_clock::now() - slots[slot].taken > late_after;
+        lock.lock();
+
+        free_slots.push_back(slot);
+        slot_freed.notify_one();
+        if (!ok)
+        {
+            failed++;
+            continue;
+        }
+
+        written++;
+        bytes += encoder.data().size();
+        late += was_late;
+        if (written % 100 == 0)
+            cout << "written all RU points 100 times, total: " << written << endl;
+    }
+}
+
+void TelemetryWriter::encode(TickSnapshot &snapshot)
+{
+    encoder.clear();
+
+    // UEs that joined during the tick, with their demand and closest RUs
+    for (size_t i = 0; i < snapshot.ues.size(); i++)
+    {
+        const RU_entry *sig_arr = &snapshot.ue_sig_arrs[i * closest_rus];
+
+        encoder.begin(ue_tags, snapshot.ues[i].id);
+        encoder.field("demand", snapshot.ues[i].demand);
+
+        if (encoding == TelemetryEncoding::compact)
+        {
+            near_ids.clear();
+            near_sigs.clear();
+            for (int j = 0; j < closest_rus; j++)
+            {
+                near_ids.push_back(sig_arr[j].ru);
+                near_sigs.push_back(sig_arr[j].sig_str);
+            }
+
+            encode_id_list(near_ids.data(), closest_rus, compact);
+            encoder.field("near_RU", compact);
+            encode_sig_strs(near_sigs.data(), closest_rus, compact);
+            encoder.field("near_RU_sig", compact);
+            encoder.end(snapshot.timestamp);
+            continue;
+        }
+
+        encoder.begin_string_field("near_RU");
+        for (int j = 0; j < closest_rus; j++)
+        {
+            encoder.append(ru_uids[sig_arr[j].ru]);
+            encoder.append(",");
+        }
+        encoder.end_string_field();
+
+        encoder.begin_string_field("near_RU_sig");
+        for (int j = 0; j < closest_rus; j++)
+        {
+            encoder.append(sig_arr[j].sig_str, 6);
+            encoder.append(",");
+        }
+        encoder.end_string_field();
+
+        encoder.end(snapshot.timestamp);
+    }
+
+    for (int i = 0; i < snapshot.num_rus; i++)
+    {
+        RUSample &sample = snapshot.rus[i];
+
+        encoder.begin(ru_tags[sample.ru]);
+        encoder.field("free_PRB", sample.free_PRB);
+        encoder.field("current_load", sample.current_load);
+        encoder.field("p", sample.p);
+        encoder.field("p_tot", sample.p_tot);
+        encoder.field("connections", sample.connections);
+        encoder.end(snapshot.timestamp);
+    }
+
+    if (!snapshot.write_total)
+        return;
+
+    // Network's total power consumption and energy consumed
+    encoder.begin(total_tags);
+    encoder.field("sleeping_RUs", snapshot.sleeping_RUs);
+    encoder.field("total_P", snapshot.total_P);
+    encoder.field("total_E", snapshot.total_E);
+    encoder.end(snapshot.timestamp);
+}
+
+const long TelemetryWriter::get_written()
+{
+    lock_guard<std::mutex> lock(mutex);
+    return written;
+}
+
+const long TelemetryWriter::get_failed()
+{
+    lock_guard<std::mutex> lock(mutex);
+    return failed;
+}
+
+const long TelemetryWriter::get_dropped()
+{
+    lock_guard<std::mutex> lock(mutex);
+    return dropped;
+}
+
+const long TelemetryWriter::get_coalesced()
+{
+    lock_guard<std::mutex> lock(mutex);
+    return coalesced;
+}
+
+const long TelemetryWriter::get_late()
+{
+    lock_guard<std::mutex> lock(mutex);
+    return late;
+}
+
+const long long TelemetryWriter::get_bytes()
+{
+    lock_guard<std::mutex> lock(mutex);
+    return bytes;
+}
+
+TelemetrySink *TelemetryWriter::get_sink()
+{
+    return sink.get();
+}
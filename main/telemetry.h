@@ -0,0 +1,169 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "components.h"
+#include "line_protocol.h"
+#include "telemetry_sink.h"
+
+// What to do when a tick is done but every snapshot slot is still waiting to be written
+enum class OverflowPolicy
+{
+    block,       // wait for the writer to free a slot, nothing is lost but ticks are held up by the database
+    drop_oldest, // reuse the oldest snapshot that hasn't been written yet, in changes mode every RU is written on the next tick
+    coalesce     // merge the tick into the newest snapshot, keeping its UEs but replacing its RU state
+};
+
+// Which RU points are written each tick
+enum class TelemetryMode
+{
+    full,   // every RU on every tick
+    changes // only RUs whose state changed, plus a heartbeat for each RU every so many ticks
+};
+
+// How the connections, near_RU and near_RU_sig fields are written
+enum class TelemetryEncoding
+{
+    text,   // comma separated uids and signal strengths, e.g. "UE_1,UE_2,"
+    compact // delta varint ids and quantized signal strengths in base64, see compact_codec.h
+};
+
+// RU state sampled during a tick
+struct RUSample
+{
+    int ru;
+    int free_PRB;
+    float current_load;
+    float p;
+    float p_tot;
+    std::string connections;
+};
+
+// UE that joined the network during a tick
+struct UESample
+{
+    int id;
+    int demand;
+};
+
+/// @brief Everything that is written to the database for one tick, strings for UEs are only built by the writer thread
+struct TickSnapshot
+{
+    long tick_no;
+    std::chrono::steady_clock::time_point taken; // wall time the snapshot was published, used to tell late ticks
+    long long timestamp;                         // time of the points in the database, nanoseconds since the epoch
+    std::vector<RUSample> rus;                   // RUs to write, ordered by RU index, only the first num_rus entries are used
+    int num_rus;                                 // so that the strings of unused entries keep their capacity for later ticks
+    bool coalesced;                              // set by acquire if the snapshot already holds an earlier tick to merge into
+    bool dropped;                                // set by acquire if an unwritten tick was thrown away to free the snapshot
+    bool write_total;                            // whether sim_total is written for this tick
+    std::vector<UESample> ues;
+    std::vector<RU_entry> ue_sig_arrs;           // closest RUs of each UE in ues, closest_rus entries per UE
+    int sleeping_RUs;
+    float total_P;
+    float total_E;
+};
+
+/// @brief Decides which RU samples go into a tick's snapshot. In changes mode an RU is written only if its free PRBs, load,
+/// power or connections differ from what was last written for it, or when its heartbeat is due. Heartbeats are spread out
+/// over the heartbeat period by RU index, so they don't all land on the same tick. p_tot changes on every tick for any RU
+/// that draws power, so it is not compared, its latest value is written along with each point instead. Changes in a tick
+/// that gets dropped would never reach the database, so the tick after a drop writes every RU
+class RUSampleFilter
+{
+private:
+    TelemetryMode mode = TelemetryMode::full;
+    int heartbeat = 100;
+    bool resend = false;           // write every RU this tick
+    std::vector<RUSample> written; // last written state of each RU
+    std::vector<char> due;         // whether each RU is written this tick
+    std::vector<RUSample> merged;  // scratch space for merging into a coalesced snapshot
+
+public:
+    void start(TelemetryMode mode, int heartbeat, int num_rus);
+
+    /// @brief Writes every RU on the coming tick, for when what was last written of them may have been dropped
+    void resend_all();
+
+    /// @brief Decides if an RU is written this tick, can be called for different RUs in parallel
+    /// @param maybe_changed false if the RU's state is known to be unchanged since the last tick, which skips comparing it
+    void check(const RUSample &sample, long tick_no, bool maybe_changed);
+
+    /// @brief Copies the RUs that are due into a snapshot, merging with the RUs already in it if it was coalesced
+    void fill(TickSnapshot *snapshot, const std::vector<RUSample> &samples);
+};
+
+/// @brief Thread writing tick snapshots to the database, so that ticks never wait on a database round trip (unless the
+/// block policy is used and the writer falls behind). Snapshots live in a fixed ring of slots that are reused between ticks:
+/// the simulation fills one slot while the writer works through the others. Each snapshot is encoded as line protocol
+/// and handed to the sink in one write
+class TelemetryWriter
+{
+private:
+    std::vector<TickSnapshot> slots;
+    std::vector<int> free_slots; // slots that neither side is using
+    std::deque<int> queued;      // published slots waiting to be written, oldest first
+    std::mutex mutex;
+    std::condition_variable slot_freed;
+    std::condition_variable slot_queued;
+    std::thread writer;
+    bool stopping = false;
+    std::unique_ptr<TelemetrySink> sink;
+
+    OverflowPolicy policy = OverflowPolicy::block;
+    std::chrono::duration<double> late_after;
+    std::vector<std::string> ru_uids;
+    std::vector<std::string> ru_tags; // precomputed line protocol tag set of each RU
+    std::string ue_tags;              // line protocol tag set of a UE, completed by its id
+    std::string total_tags;
+    LineEncoder encoder;              // reused for every snapshot, so that encoding doesn't allocate once it has grown to fit a tick
+    int closest_rus = 0;
+    TelemetryEncoding encoding = TelemetryEncoding::text;
+    std::vector<int> near_ids;        // scratch space for compact near_RU fields
+    std::vector<float> near_sigs;
+    std::string compact;
+
+    long written = 0;   // ticks written to the database
+    long failed = 0;    // ticks the sink failed to write
+    long dropped = 0;   // ticks thrown away by drop_oldest
+    long coalesced = 0; // ticks whose RU state was replaced by a later tick
+    long late = 0;      // ticks written more than late_after after they were published
+    long long bytes = 0; // line protocol written by the sink
+
+    void work();
+    void encode(TickSnapshot &snapshot);
+
+public:
+    /// @brief Starts the writer thread, RUs must not be exchanged while it runs
+    /// @param sink where encoded ticks are written, owned by the writer until it is started again
+    /// @param policy what to do when all slots are taken
+    /// @param num_slots number of snapshots that can be in flight, at least 2
+    /// @param late_after seconds after which a written tick counts as late
+    /// @param encoding how the near_RU and near_RU_sig fields of UEs are written, connections are encoded by the simulation
+    void start(std::unique_ptr<TelemetrySink> sink, OverflowPolicy policy, int num_slots, double late_after, std::vector<RU> &rus, int closest_rus,
+               TelemetryEncoding encoding = TelemetryEncoding::text);
+
+    /// @brief Writes everything that has been published, then stops the writer thread and prints the counters
+    void stop();
+
+    /// @brief Takes a slot for the simulation to fill in. Depending on the policy this may wait for the writer, drop the oldest
+    /// queued snapshot or hand back the newest one to be merged into, in which case its UEs are kept and should be appended to
+    TickSnapshot *acquire();
+
+    /// @brief Queues a filled in slot for writing
+    void publish(TickSnapshot *snapshot);
+
+    const long get_written();
+    const long get_failed();
+    const long get_dropped();
+    const long get_coalesced();
+    const long get_late();
+    const long long get_bytes();
+
+    /// @brief The sink the writer was started with, e.g. for inspecting a MemorySink once the writer is stopped
+    TelemetrySink *get_sink();
+};
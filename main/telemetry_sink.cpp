@@ -0,0 +1,159 @@
+#include <iostream>
+#include "telemetry_sink.h"
+
+using namespace std;
+
+InfluxSink::InfluxSink(const string &url) : client(url)
+{
+}
+
+bool InfluxSink::write(const string &body)
+{
+    return client.write(body);
+}
+
+bool NullSink::write(const string &)
+{
+    return true;
+}
+
+RotatingFileSink::RotatingFileSink(const string &path, long max_bytes, int keep)
+{
+    this->path = path;
+    this->max_bytes = max_bytes;
+    this->keep = keep;
+}
+
+RotatingFileSink::~RotatingFileSink()
+{
+    if (file != nullptr)
+        close_file();
+}
+
+bool RotatingFileSink::open_file()
+{
+    file = fopen(path.c_str(), "a");
+    if (file == nullptr)
+    {
+        if (!failing)
+            cout << "Warning! Unable to open telemetry file " << path << ", telemetry is discarded until it can be opened" << endl;
+        failing = true;
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    file_bytes = ftell(file);
+    failing = false;
+    return true;
+}
+
+void RotatingFileSink::close_file()
+{
+    // fclose writes out what is still buffered, so a full disk may only show up here
+    if (fclose(file) != 0)
+        cout << "Warning! Unable to close telemetry file " << path << ", its last ticks may be lost" << endl;
+    file = nullptr;
+}
+
+void RotatingFileSink::rotate()
+{
+    close_file();
+
+    // path.(keep - 1) becomes path.keep, replacing the oldest file, and so on down to path becoming path.1
+    for (int i = keep - 1; i >= 0; i--)
+    {
+        string from = (i == 0) ? path : path + "." + to_string(i);
+        rename(from.c_str(), (path + "." + to_string(i + 1)).c_str());
+    }
+    if (keep == 0)
+        remove(path.c_str());
+}
+
+bool RotatingFileSink::write(const string &body)
+{
+    if (file == nullptr && !open_file())
+        return false;
+
+    size_t n = fwrite(body.data(), 1, body.size(), file);
+    file_bytes += n;
+    if (n != body.size())
+    {
+        if (!failing)
+            cout << "Warning! Unable to write to telemetry file " << path << ", telemetry is discarded until it can be written" << endl;
+        failing = true;
+        return false;
+    }
+    failing = false;
+
+    if (file_bytes >= max_bytes)
+        rotate();
+
+    return true;
+}
+
+MemorySink::MemorySink(int max_bodies)
+{
+    this->max_bodies = max(max_bodies, 1);
+}
+
+bool MemorySink::write(const string &body)
+{
+    lock_guard<std::mutex> lock(mutex);
+
+    if (bodies.size() == max_bodies)
+    {
+        spare.push_back(move(bodies.front()));
+        bodies.pop_front();
+    }
+
+    if (spare.empty())
+        bodies.push_back(body);
+    else
+    {
+        bodies.push_back(move(spare.back()));
+        spare.pop_back();
+        bodies.back().assign(body);
+    }
+
+    written++;
+    bytes += body.size();
+    return true;
+}
+
+vector<string> MemorySink::get_bodies()
+{
+    lock_guard<std::mutex> lock(mutex);
+    return vector<string>(bodies.begin(), bodies.end());
+}
+
+const long MemorySink::get_written()
+{
+    lock_guard<std::mutex> lock(mutex);
+    return written;
+}
+
+const long long MemorySink::get_bytes()
+{
+    lock_guard<std::mutex> lock(mutex);
+    return bytes;
+}
+
+unique_ptr<TelemetrySink> make_telemetry_sink(TelemetrySinkType type, const string &target, long max_bytes, int keep, int max_bodies)
+{
+    switch (type)
+    {
+    case TelemetrySinkType::influx:
+        return make_unique<InfluxSink>(target);
+
+    case TelemetrySinkType::null:
+        return make_unique<NullSink>();
+
+    case TelemetrySinkType::file:
+        return make_unique<RotatingFileSink>(target, max_bytes, keep);
+
+    case TelemetrySinkType::memory:
+        return make_unique<MemorySink>(max_bodies);
+    }
+
+    return nullptr; // should be unreachable
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "influx_http.h"
+
+// Where the telemetry writer sends each tick's line protocol
+enum class TelemetrySinkType
+{
+    influx, // posted to InfluxDB, which the xApps read the simulation state from
+    null,   // thrown away, for measuring the simulation without a database
+    file,   // appended to a file that is rotated once it grows too large
+    memory  // kept in a ring of the latest bodies in memory, where tests and benchmarks can inspect them
+};
+
+/// @brief Destination of encoded telemetry. Bodies are only written from the telemetry writer thread, one tick's worth of
+/// line protocol at a time
+class TelemetrySink
+{
+public:
+    virtual ~TelemetrySink() = default;
+
+    /// @return true if the body was stored
+    virtual bool write(const std::string &body) = 0;
+};
+
+class InfluxSink : public TelemetrySink
+{
+private:
+    InfluxHttpClient client;
+
+public:
+    InfluxSink(const std::string &url);
+    bool write(const std::string &body) override;
+};
+
+class NullSink : public TelemetrySink
+{
+public:
+    bool write(const std::string &body) override;
+};
+
+/// @brief Appends bodies to a file as plain line protocol, one tick after the other. Once the file has grown past max_bytes
+/// it is renamed to path.1 (path.1 to path.2 and so on, keeping at most keep old files) and a new file is started
+class RotatingFileSink : public TelemetrySink
+{
+private:
+    std::string path;
+    long max_bytes;
+    int keep;
+    FILE *file = nullptr;
+    long file_bytes = 0;
+    bool failing = false; // so that failures are only reported once
+
+    bool open_file();
+    void close_file();
+    void rotate();
+
+public:
+    RotatingFileSink(const std::string &path, long max_bytes, int keep);
+    ~RotatingFileSink();
+    bool write(const std::string &body) override;
+};
+
+/// @brief Keeps the latest max_bodies bodies in memory, older ones are dropped. Can be inspected from any thread while the
+/// writer runs
+class MemorySink : public TelemetrySink
+{
+private:
+    std::mutex mutex;
+    std::deque<std::string> bodies; // oldest first
+    std::vector<std::string> spare; // strings of dropped bodies, reused so that a full ring doesn't allocate
+    size_t max_bodies;
+    long written = 0;
+    long long bytes = 0;
+
+public:
+    MemorySink(int max_bodies);
+    bool write(const std::string &body) override;
+
+    /// @brief Copies the bodies currently in the ring, oldest first
+    std::vector<std::string> get_bodies();
+    const long get_written();     // bodies written in total, including dropped ones
+    const long long get_bytes();  // bytes written in total, including dropped bodies
+};
+
+/// @brief Creates a sink of the given type
+/// @param target database url for influx, file path for file
+/// @param max_bytes size at which a file sink rotates
+/// @param keep number of rotated files a file sink keeps
+/// @param max_bodies number of bodies a memory sink keeps
+std::unique_ptr<TelemetrySink> make_telemetry_sink(TelemetrySinkType type, const std::string &target, long max_bytes, int keep,
+                                                   int max_bodies);
@@ -0,0 +1,148 @@
+// Compares the telemetry write path with the one it replaced: points built with influxdb-cxx and written in batches of
+// 100, against LineEncoder posting one body per tick through InfluxHttpClient. Each tick writes the sim_RUs points of
+// 100 RUs with 8 connected UEs each and a sim_total point, which is what the simulator's default grid sends. Needs
+// influxdb-cxx, like the simulator, and InfluxDB (or anything answering /write) at the url. Build and run from main/tests
+// with
+//
+//   g++ -std=c++17 -O2 -I.. -o influx_write_bench influx_write_bench.cpp ../line_protocol.cpp ../influx_http.cpp
+//       -lInfluxDB
+//   ./influx_write_bench http://localhost:8086?db=RIC-Test 2000
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <InfluxDBFactory.h>
+#include "influx_http.h"
+#include "line_protocol.h"
+
+using namespace std;
+
+#define NUM_RUS 100
+#define UES_PER_RU 8
+
+// RU state written every tick, varied a little per tick so that no two ticks encode the same
+struct BenchRU
+{
+    string uid;
+    string type;
+    string connections;
+    int free_PRB;
+    float current_load;
+    float p;
+    float p_tot;
+};
+
+static vector<BenchRU> make_rus()
+{
+    vector<BenchRU> rus;
+    for (int i = 0; i < NUM_RUS; i++)
+    {
+        BenchRU ru = {"RU_" + to_string(i), i % 50 == 0 ? "macro" : "micro", "", 40, 0.6f, 5000.5f, 0};
+        for (int j = 0; j < UES_PER_RU; j++)
+            ru.connections += "UE_" + to_string(i * UES_PER_RU + j) + ",";
+        rus.push_back(ru);
+    }
+    return rus;
+}
+
+static double seconds_since(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+/// @brief Writes ticks the way TelemetryWriter did with influxdb-cxx
+static double bench_influxdb_cxx(const string &url, int ticks)
+{
+    vector<BenchRU> rus = make_rus();
+    auto influxdb = influxdb::InfluxDBFactory::Get(url);
+    influxdb->batchOf(100);
+
+    auto start = chrono::steady_clock::now();
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        for (auto &&ru : rus)
+        {
+            ru.p_tot += ru.p;
+            influxdb->write(influxdb::Point{"sim_RUs"}
+                                .addTag("uid", ru.uid)
+                                .addTag("RU_type", ru.type)
+                                .addField("free_PRB", ru.free_PRB + tick % 2)
+                                .addField("current_load", ru.current_load)
+                                .addField("p", ru.p)
+                                .addField("p_tot", ru.p_tot)
+                                .addField("connections", ru.connections));
+        }
+
+        influxdb->write(influxdb::Point{"sim_total"}
+                            .addField("sleeping_RUs", tick % 7)
+                            .addField("total_P", 500050.0f)
+                            .addField("total_E", (float)tick));
+    }
+    influxdb->flushBatch();
+    return seconds_since(start);
+}
+
+/// @brief Writes ticks the way TelemetryWriter does now
+static double bench_line_encoder(const string &url, int ticks, long &failed)
+{
+    vector<BenchRU> rus = make_rus();
+    vector<string> ru_tags;
+    for (auto &&ru : rus)
+        ru_tags.push_back(LineEncoder::tag_set("sim_RUs", {{"uid", ru.uid}, {"RU_type", ru.type}}));
+    string total_tags = LineEncoder::tag_set("sim_total", {});
+
+    LineEncoder encoder;
+    InfluxHttpClient client(url);
+    failed = 0;
+
+    auto start = chrono::steady_clock::now();
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        long long timestamp = chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch()).count();
+        encoder.clear();
+        for (int i = 0; i < NUM_RUS; i++)
+        {
+            BenchRU &ru = rus[i];
+            ru.p_tot += ru.p;
+            encoder.begin(ru_tags[i]);
+            encoder.field("free_PRB", ru.free_PRB + tick % 2);
+            encoder.field("current_load", ru.current_load);
+            encoder.field("p", ru.p);
+            encoder.field("p_tot", ru.p_tot);
+            encoder.field("connections", ru.connections);
+            encoder.end(timestamp);
+        }
+
+        encoder.begin(total_tags);
+        encoder.field("sleeping_RUs", tick % 7);
+        encoder.field("total_P", 500050.0f);
+        encoder.field("total_E", (float)tick);
+        encoder.end(timestamp);
+
+        failed += !client.write(encoder.data());
+    }
+    return seconds_since(start);
+}
+
+extern int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        cout << "usage: " << argv[0] << " <influxdb url> [ticks]" << endl;
+        return 1;
+    }
+    string url = argv[1];
+    int ticks = argc > 2 ? stoi(argv[2]) : 2000;
+
+    double cxx = bench_influxdb_cxx(url, ticks);
+    long failed;
+    double encoder = bench_line_encoder(url, ticks, failed);
+
+    cout << "influxdb-cxx, batches of 100 points: " << cxx / ticks * 1e6 << " us per tick" << endl;
+    cout << "LineEncoder and InfluxHttpClient:    " << encoder / ticks * 1e6 << " us per tick";
+    if (failed > 0)
+        cout << " (" << failed << " writes failed, check the url)";
+    cout << endl;
+    return 0;
+}
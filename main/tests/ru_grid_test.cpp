@@ -0,0 +1,153 @@
+// Checks the closest-RU lookup against brute force. score_rus must give bit for bit the signal strengths of sig_str_at
+// for every block length, whichever of AVX2, SSE2 or the scalar loop the build uses. RUGrid::query must find k RUs as
+// strong as the k strongest of all RUs, in descending order, for points inside and outside of the grid, on the default
+// RU grid with its macro-RUs, a larger grid with a macro-RU every 50 RUs and a randomly scattered network. Build and run
+// from main/tests with
+//
+//   g++ -std=c++17 -O2 -I.. -o ru_grid_test ru_grid_test.cpp ../ru_grid.cpp ../sig_kernel.cpp ../components.cpp ../checkpoint.cpp
+//   ./ru_grid_test
+//
+// and again with -mavx2 or -march=native added to also check the AVX2 kernel and builds where the target has FMA
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "ru_grid.h"
+#include "sig_kernel.h"
+
+using namespace std;
+
+#define SEED 42
+#define NUM_QUERIES 20000
+#define MAX_COORD 5000.0f
+
+static const int ks[] = {1, 3, 4, 8, 10, 16};
+
+/// @brief Builds a grid_size x grid_size grid of micro-RUs, with every macro_stride:th of them (if above 0) a macro-RU
+static vector<RU> make_grid(int grid_size, int macro_stride)
+{
+    vector<RU> rus;
+    float spacing = MAX_COORD * 0.6f / (grid_size - 1);
+    for (int i = 0; i < grid_size * grid_size; i++)
+    {
+        float coords[2] = {MAX_COORD * 0.2f + (i % grid_size) * spacing, MAX_COORD * 0.2f + (i / grid_size) * spacing};
+        bool macro = macro_stride > 0 && i % macro_stride == 0;
+        rus.push_back(RU("RU_" + to_string(i), coords, macro ? 4 : 2, macro ? 20000000 : 2000000, macro));
+    }
+    return rus;
+}
+
+/// @brief Scatters num_rus RUs at random over the map, one in twenty a macro-RU
+static vector<RU> make_scattered(int num_rus, mt19937 &gen)
+{
+    uniform_real_distribution<float> coord(0, MAX_COORD);
+    vector<RU> rus;
+    for (int i = 0; i < num_rus; i++)
+    {
+        float coords[2] = {coord(gen), coord(gen)};
+        bool macro = i % 20 == 0;
+        rus.push_back(RU("RU_" + to_string(i), coords, macro ? 4 : 2, macro ? 20000000 : 2000000, macro));
+    }
+    return rus;
+}
+
+/// @brief Scores random blocks of every length up to 200 with score_rus and with sig_str_at
+/// @return true if every result is bit-identical
+static bool check_kernel(mt19937 &gen)
+{
+    uniform_real_distribution<float> coord(-1000, MAX_COORD + 1000);
+    for (int n = 1; n <= 200; n++)
+    {
+        vector<float> x(n), y(n), range(n), out(n);
+        for (int i = 0; i < n; i++)
+        {
+            x[i] = coord(gen);
+            y[i] = coord(gen);
+            range[i] = i % 7 == 0 ? 2000.0f : 500.0f;
+        }
+        float coords[2] = {coord(gen), coord(gen)};
+        score_rus(coords, x.data(), y.data(), range.data(), n, out.data());
+
+        for (int i = 0; i < n; i++)
+        {
+            float expected = sig_str_at(x[i] - coords[0], y[i] - coords[1], range[i]);
+            if (memcmp(&out[i], &expected, sizeof(float)) != 0)
+            {
+                cout << "FAIL score_rus differs from sig_str_at for RU " << i << " of a block of " << n << endl;
+                return false;
+            }
+        }
+    }
+
+    cout << "ok   score_rus matches sig_str_at on blocks of 1 to 200 RUs" << endl;
+    return true;
+}
+
+/// @brief Looks up the closest RUs of random points through RUGrid and by scoring every RU
+/// @return true if the grid finds RUs as strong as brute force on every query
+static bool check_grid(const string &name, vector<RU> rus, mt19937 &gen)
+{
+    RUGrid grid;
+    grid.build(rus.data(), rus.size());
+    uniform_real_distribution<float> coord(-1000, MAX_COORD + 1000);
+
+    vector<float> all(rus.size());
+    vector<RU_entry> out(16);
+    for (int q = 0; q < NUM_QUERIES; q++)
+    {
+        float coords[2] = {coord(gen), coord(gen)};
+        for (size_t i = 0; i < rus.size(); i++)
+            all[i] = sig_str_at(rus[i].get_coords()[0] - coords[0], rus[i].get_coords()[1] - coords[1], rus[i].get_range());
+        vector<float> strongest = all;
+        sort(strongest.begin(), strongest.end(), greater<float>());
+
+        for (int k : ks)
+        {
+            int expected = min(k, (int)rus.size());
+            int found = grid.query(coords, out.data(), k);
+            bool ok = found == expected;
+
+            // RUs of equal strength may come in any order, so the strengths are compared rather than the RUs themselves
+            for (int i = 0; ok && i < found; i++)
+                ok = out[i].ru >= 0 && out[i].ru < (int)rus.size() && out[i].sig_str == all[out[i].ru] &&
+                     out[i].sig_str == strongest[i] &&
+                     find_if(out.begin(), out.begin() + i, [&](const RU_entry &e) { return e.ru == out[i].ru; }) == out.begin() + i;
+
+            if (!ok)
+            {
+                cout << "FAIL " << name << ": the " << k << " closest RUs of (" << coords[0] << ", " << coords[1]
+                     << ") differ from brute force" << endl;
+                return false;
+            }
+        }
+    }
+
+    cout << "ok   " << name << ": " << NUM_QUERIES << " queries match brute force" << endl;
+    return true;
+}
+
+extern int main()
+{
+    mt19937 gen(SEED);
+
+    bool ok = check_kernel(gen);
+
+    vector<RU> default_grid = make_grid(10, 0);
+    int macros[] = {25, 50, 75};
+    for (int i : macros)
+    {
+        float coords[2] = {default_grid[i].get_coords()[0], default_grid[i].get_coords()[1]};
+        default_grid[i] = RU("RU_" + to_string(i), coords, 4, 20000000, true);
+    }
+    ok = check_grid("default 10x10 grid", default_grid, gen) && ok;
+    ok = check_grid("40x40 grid, macro stride 50", make_grid(40, 50), gen) && ok;
+    ok = check_grid("2000 scattered RUs", make_scattered(2000, gen), gen) && ok;
+    ok = check_grid("5 scattered RUs", make_scattered(5, gen), gen) && ok;
+
+    cout << (ok ? "PASSED" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,295 @@
+// Checks that telemetry_mode = changes loses no RU state. A seeded network of RUs whose load changes at random is written
+// through RUSampleFilter and TelemetryWriter into a MemorySink the same way simulate_tick does it, once with every RU on
+// every tick and then with changes only. Replaying the points of a changes run tick by tick must give the same RU state as
+// the full run on every tick that reached the sink, also under drop-oldest with a sink too slow to keep up. Ticks the
+// sink fails to write must be counted as failed rather than written. Build and run from main/tests with
+//
+//   g++ -std=c++17 -O2 -I.. -o telemetry_filter_test telemetry_filter_test.cpp ../telemetry.cpp ../telemetry_sink.cpp
+//       ../line_protocol.cpp ../compact_codec.cpp ../components.cpp ../influx_http.cpp ../checkpoint.cpp -lpthread
+//   ./telemetry_filter_test
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "telemetry.h"
+
+using namespace std;
+
+#define SEED 42
+#define NUM_RUS 64
+#define NUM_TICKS 3000
+#define HEARTBEAT 100
+#define CHANGE_RATE 0.02 // chance of an RU's load changing on a tick
+
+using RUState = map<string, string>;       // field name to its encoded value, without p_tot which changes on every tick
+using NetworkState = map<string, RUState>; // RU uid to its last written fields
+
+/// @brief MemorySink that stalls every so many writes, so that the writer falls behind the simulation
+class SlowMemorySink : public MemorySink
+{
+private:
+    int slow_every;
+    long writes = 0;
+
+public:
+    SlowMemorySink(int max_bodies, int slow_every) : MemorySink(max_bodies), slow_every(slow_every) {}
+
+    bool write(const string &body) override
+    {
+        if (slow_every > 0 && ++writes % slow_every == 0)
+            this_thread::sleep_for(chrono::milliseconds(2));
+        return MemorySink::write(body);
+    }
+};
+
+/// @brief MemorySink that fails every so many writes, keeping nothing of them
+class FailingMemorySink : public MemorySink
+{
+private:
+    int fail_every;
+    long writes = 0;
+
+public:
+    FailingMemorySink(int max_bodies, int fail_every) : MemorySink(max_bodies), fail_every(fail_every) {}
+
+    bool write(const string &body) override
+    {
+        if (++writes % fail_every == 0)
+            return false;
+        return MemorySink::write(body);
+    }
+};
+
+/// @brief Simulates NUM_TICKS ticks of the seeded network and writes them to a sink
+/// @param slow_every stall the sink on every slow_every:th write and pace the ticks, 0 to run both flat out
+/// @param dropped set to the number of ticks the writer dropped
+/// @return the bodies the sink got, one per written tick
+static vector<string> run(TelemetryMode mode, OverflowPolicy policy, int num_slots, int slow_every, long &dropped)
+{
+    mt19937 gen(SEED);
+    uniform_real_distribution<float> chance(0, 1);
+
+    vector<RU> rus;
+    for (int i = 0; i < NUM_RUS; i++)
+    {
+        float coords[2] = {i * 100.0f, 0};
+        rus.push_back(RU("RU_" + to_string(i), coords, 2, 2000000));
+    }
+    vector<RUSample> samples(NUM_RUS);
+    vector<char> ru_changed(NUM_RUS, true);
+
+    RUSampleFilter filter;
+    filter.start(mode, HEARTBEAT, NUM_RUS);
+
+    auto sink = make_unique<SlowMemorySink>(NUM_TICKS + 1, slow_every);
+    SlowMemorySink *memory = sink.get();
+    TelemetryWriter writer;
+    writer.start(move(sink), policy, num_slots, 1.0, rus, 0);
+
+    for (long tick_no = 1; tick_no <= NUM_TICKS; tick_no++)
+    {
+        double now = tick_no * 0.01;
+        if (slow_every > 0)
+            this_thread::sleep_for(chrono::microseconds(100));
+        TickSnapshot *snapshot = writer.acquire();
+        if (snapshot->dropped)
+            filter.resend_all();
+
+        // the random draws don't depend on the mode or on what gets written, so every run sees the same network
+        for (int i = 0; i < NUM_RUS; i++)
+        {
+            if (chance(gen) < CHANGE_RATE)
+            {
+                rus[i].set_alloc_PRB(uniform_int_distribution<int>(0, rus[i].get_num_PRB())(gen));
+                ru_changed[i] = true;
+            }
+        }
+
+        for (int i = 0; i < NUM_RUS; i++)
+        {
+            RU &ru = rus[i];
+            RUSample &sample = samples[i];
+            bool changed = ru_changed[i];
+            ru.calc_delta_p(now);
+            sample.ru = i;
+            sample.p_tot = ru.get_p_tot();
+
+            if (changed)
+            {
+                sample.free_PRB = ru.get_num_PRB() - ru.get_alloc_PRB();
+                sample.current_load = (float)ru.get_alloc_PRB() / (float)ru.get_num_PRB();
+                sample.p = ru.get_p();
+                sample.connections.clear();
+                for (int ue = 0; ue < ru.get_alloc_PRB(); ue += 5)
+                    sample.connections += "UE_" + to_string(i * 1000 + ue) + ",";
+                ru_changed[i] = false;
+            }
+
+            filter.check(sample, tick_no, changed);
+        }
+
+        // sleeping_RUs is written on every tick and tells which tick a body belongs to
+        snapshot->tick_no = tick_no;
+        filter.fill(snapshot, samples);
+        snapshot->write_total = true;
+        snapshot->sleeping_RUs = tick_no;
+        snapshot->total_P = 0;
+        snapshot->total_E = 0;
+        writer.publish(snapshot);
+    }
+
+    writer.stop();
+    dropped = writer.get_dropped();
+    return memory->get_bodies();
+}
+
+/// @brief Splits a line protocol line into its measurement with tags and its fields, keeping string fields quoted
+static void parse_line(const string &line, string &tags, RUState &fields)
+{
+    size_t space = line.find(' ');
+    tags = line.substr(0, space);
+    fields.clear();
+
+    bool quoted = false;
+    size_t start = space + 1;
+    for (size_t i = start; i <= line.size(); i++)
+    {
+        if (i < line.size() && line[i] == '"' && line[i - 1] != '\\')
+            quoted = !quoted;
+        if (i < line.size() && (quoted || (line[i] != ',' && line[i] != ' ')))
+            continue;
+
+        string field = line.substr(start, i - start);
+        size_t eq = field.find('=');
+        fields[field.substr(0, eq)] = field.substr(eq + 1);
+        start = i + 1;
+        if (i == line.size() || line[i] == ' ')
+            break; // the rest is the timestamp
+    }
+}
+
+/// @brief Applies the RU points of each body to the network state written so far
+/// @return the state of the network after each tick that was written, by tick number
+static map<long, NetworkState> replay(const vector<string> &bodies)
+{
+    map<long, NetworkState> ticks;
+    NetworkState state;
+    string tags;
+    RUState fields;
+
+    for (auto &&body : bodies)
+    {
+        size_t begin = 0;
+        size_t end;
+        while ((end = body.find('\n', begin)) != string::npos)
+        {
+            parse_line(body.substr(begin, end - begin), tags, fields);
+            begin = end + 1;
+
+            if (tags.rfind("sim_RUs,", 0) == 0)
+            {
+                string uid = tags.substr(tags.find("uid=") + 4);
+                uid = uid.substr(0, uid.find(','));
+                fields.erase("p_tot");
+                state[uid] = fields;
+            }
+            else if (tags.rfind("sim_total", 0) == 0)
+                ticks[stol(fields["sleeping_RUs"])] = state; // the last line of a tick
+        }
+    }
+
+    return ticks;
+}
+
+/// @brief Compares the replayed state of a run with the full run on every tick the run wrote
+/// @return true if every written tick matches
+static bool check(const string &name, const map<long, NetworkState> &full, const vector<string> &bodies)
+{
+    map<long, NetworkState> ticks = replay(bodies);
+    size_t bytes = 0;
+    for (auto &&body : bodies)
+        bytes += body.size();
+
+    for (auto &&[tick_no, state] : ticks)
+    {
+        const NetworkState &expected = full.at(tick_no);
+        for (auto &&[uid, fields] : expected)
+        {
+            auto it = state.find(uid);
+            if (it == state.end() || it->second != fields)
+            {
+                cout << "FAIL " << name << ": " << uid << " differs from the full run at tick " << tick_no << endl;
+                return false;
+            }
+        }
+    }
+
+    cout << "ok   " << name << ": " << ticks.size() << " ticks written in " << bytes << " bytes all match the full run" << endl;
+    return true;
+}
+
+/// @brief Writes the totals of NUM_TICKS ticks to a sink that fails every third write
+/// @return true if the writer counts exactly the ticks that reached the sink as written, and only their bytes
+static bool check_failed_writes()
+{
+    vector<RU> rus;
+    auto sink = make_unique<FailingMemorySink>(NUM_TICKS + 1, 3);
+    FailingMemorySink *memory = sink.get();
+    TelemetryWriter writer;
+    writer.start(move(sink), OverflowPolicy::block, 4, 1.0, rus, 0);
+
+    for (long tick_no = 1; tick_no <= NUM_TICKS; tick_no++)
+    {
+        TickSnapshot *snapshot = writer.acquire();
+        snapshot->tick_no = tick_no;
+        snapshot->write_total = true;
+        snapshot->sleeping_RUs = tick_no;
+        snapshot->total_P = 0;
+        snapshot->total_E = 0;
+        writer.publish(snapshot);
+    }
+    writer.stop();
+
+    if (writer.get_failed() != NUM_TICKS / 3 || writer.get_written() != memory->get_written() ||
+        writer.get_written() + writer.get_failed() != NUM_TICKS || writer.get_bytes() != memory->get_bytes())
+    {
+        cout << "FAIL failed writes: " << writer.get_written() << " ticks counted as written and " << writer.get_failed()
+             << " as failed, the sink got " << memory->get_written() << " of " << NUM_TICKS << endl;
+        return false;
+    }
+
+    cout << "ok   failed writes: " << writer.get_failed() << " of " << NUM_TICKS << " ticks counted as failed" << endl;
+    return true;
+}
+
+extern int main()
+{
+    long dropped;
+    vector<string> full_bodies = run(TelemetryMode::full, OverflowPolicy::block, 4, 0, dropped);
+    map<long, NetworkState> full = replay(full_bodies);
+    if (full.size() != NUM_TICKS)
+    {
+        cout << "FAIL full run wrote " << full.size() << " of " << NUM_TICKS << " ticks" << endl;
+        return 1;
+    }
+
+    bool ok = check("changes, block", full, run(TelemetryMode::changes, OverflowPolicy::block, 4, 0, dropped));
+
+    vector<string> bodies = run(TelemetryMode::changes, OverflowPolicy::drop_oldest, 2, 10, dropped);
+    if (dropped == 0)
+    {
+        cout << "FAIL changes, drop-oldest: the sink kept up, nothing was dropped" << endl;
+        ok = false;
+    }
+    else
+        ok = check("changes, drop-oldest (" + to_string(dropped) + " ticks dropped)", full, bodies) && ok;
+
+    ok = check_failed_writes() && ok;
+
+    cout << (ok ? "PASSED" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,233 @@
+// Checks that a trace reads back as it was written. A seeded network with an odd number of RUs, where UEs join, connect,
+// move and disconnect at random, is traced tick by tick through TraceWriter the way simulate_tick does it. TraceReader
+// must then hand out aligned columns holding the written values, replaying the connection changes from the first block
+// must give every tick's connected_ues, and a block cut short at the end of the file must be left out. Writing to a
+// full disk must be reported. Build and run from main/tests with
+//
+//   g++ -std=c++17 -O2 -I.. -o trace_test trace_test.cpp ../trace.cpp ../components.cpp ../checkpoint.cpp
+//   ./trace_test
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "trace.h"
+
+using namespace std;
+
+#define SEED 42
+#define NUM_RUS 7 // odd, so the 4-byte columns need padding
+#define CLOSEST_RUS 3
+#define NUM_TICKS 500
+#define TRACE_PATH "trace_test.trace"
+
+// RU columns and header values of one written tick
+struct WrittenTick
+{
+    double t;
+    double total_E;
+    vector<double> p_tot;
+    vector<float> load;
+    vector<float> p;
+    vector<int32_t> alloc_PRB;
+    vector<int32_t> connected_ues;
+    uint32_t num_ues;
+};
+
+template <typename T>
+static bool aligned(const T *ptr)
+{
+    return (uintptr_t)ptr % alignof(T) == 0;
+}
+
+/// @brief Traces NUM_TICKS ticks of the seeded network to path
+/// @return the values written on each tick, empty if a write failed
+static vector<WrittenTick> write_trace(const string &path)
+{
+    mt19937 gen(SEED);
+    vector<RU> rus;
+    for (int i = 0; i < NUM_RUS; i++)
+    {
+        float coords[2] = {i * 100.0f, 0};
+        rus.push_back(RU("RU_" + to_string(i), coords, 2, 2000000));
+    }
+    vector<vector<UEHandle>> conn(NUM_RUS);
+    vector<int> ue_ru; // RU of each UE id, -1 if not connected
+
+    TraceWriter writer;
+    if (!writer.open(path, rus, CLOSEST_RUS, 0.01, SEED))
+        return {};
+
+    vector<WrittenTick> written;
+    double total_E = 0;
+    for (long tick_no = 0; tick_no < NUM_TICKS; tick_no++)
+    {
+        double t = tick_no * 0.01;
+        uint32_t joined = 0;
+
+        // A few UEs join, some of the connected ones move or leave, changes come in odd and even numbers
+        int joins = uniform_int_distribution<int>(0, 3)(gen);
+        for (int j = 0; j < joins; j++)
+        {
+            int ue_id = ue_ru.size();
+            RU_entry sig_arr[CLOSEST_RUS];
+            for (int k = 0; k < CLOSEST_RUS; k++)
+            {
+                sig_arr[k].ru = (ue_id + k) % NUM_RUS;
+                sig_arr[k].sig_str = -70.0f - k;
+            }
+            writer.ue_joined(ue_id, 10 + ue_id % 5, sig_arr);
+            joined++;
+
+            int ru = sig_arr[0].ru;
+            ue_ru.push_back(ru);
+            conn[ru].push_back(ue_id);
+            writer.connection_changed(ue_id, -1, ru);
+        }
+
+        int changes = uniform_int_distribution<int>(0, 2)(gen);
+        for (int c = 0; c < changes && !ue_ru.empty(); c++)
+        {
+            int ue_id = uniform_int_distribution<int>(0, ue_ru.size() - 1)(gen);
+            int from = ue_ru[ue_id];
+            int to = uniform_int_distribution<int>(-1, NUM_RUS - 1)(gen);
+            if (from == to)
+                continue;
+            if (from >= 0)
+                conn[from].erase(find(conn[from].begin(), conn[from].end(), ue_id));
+            if (to >= 0)
+                conn[to].push_back(ue_id);
+            ue_ru[ue_id] = to;
+            writer.connection_changed(ue_id, from, to);
+        }
+
+        WrittenTick tick = {t, total_E, {}, {}, {}, {}, {}, joined};
+        for (int i = 0; i < NUM_RUS; i++)
+        {
+            rus[i].set_alloc_PRB(min((int)conn[i].size() * 10, rus[i].get_num_PRB()));
+            rus[i].calc_delta_p(t);
+            tick.p_tot.push_back(rus[i].get_p_tot());
+            tick.load.push_back((float)rus[i].get_alloc_PRB() / (float)rus[i].get_num_PRB());
+            tick.p.push_back(rus[i].get_p());
+            tick.alloc_PRB.push_back(rus[i].get_alloc_PRB());
+            tick.connected_ues.push_back(conn[i].size());
+            total_E += rus[i].get_p_tot();
+        }
+
+        if (!writer.write_tick(tick_no, t, rus, conn, 0, tick.total_E, 0))
+            return {};
+        written.push_back(tick);
+    }
+
+    if (!writer.close())
+        return {};
+    return written;
+}
+
+/// @brief Compares every tick of the trace at path with the values written
+/// @return true if all of them match
+static bool check_trace(const string &path, const vector<WrittenTick> &written)
+{
+    TraceReader reader;
+    if (!reader.open(path) || reader.num_ticks() != written.size())
+    {
+        cout << "FAIL the trace has " << reader.num_ticks() << " of " << written.size() << " ticks" << endl;
+        return false;
+    }
+
+    vector<int32_t> connected(NUM_RUS, 0);
+    for (size_t i = 0; i < reader.num_ticks(); i++)
+    {
+        TickView view = reader.tick(i);
+        const WrittenTick &tick = written[i];
+
+        if (!aligned(view.p_tot) || !aligned(view.load) || !aligned(view.p) || !aligned(view.alloc_PRB) ||
+            !aligned(view.connected_ues) || !aligned(view.deltas) || !aligned(&view.ue(0, CLOSEST_RUS)))
+        {
+            cout << "FAIL a section of tick " << i << " is misaligned" << endl;
+            return false;
+        }
+
+        if (view.header->tick_no != (int64_t)i || view.header->t != tick.t || view.header->total_E != tick.total_E ||
+            view.header->num_ues != tick.num_ues ||
+            !equal(tick.p_tot.begin(), tick.p_tot.end(), view.p_tot) || !equal(tick.load.begin(), tick.load.end(), view.load) ||
+            !equal(tick.p.begin(), tick.p.end(), view.p) || !equal(tick.alloc_PRB.begin(), tick.alloc_PRB.end(), view.alloc_PRB) ||
+            !equal(tick.connected_ues.begin(), tick.connected_ues.end(), view.connected_ues))
+        {
+            cout << "FAIL tick " << i << " reads back different from what was written" << endl;
+            return false;
+        }
+
+        for (uint32_t d = 0; d < view.header->num_deltas; d++)
+        {
+            if (view.deltas[d].from_ru >= 0)
+                connected[view.deltas[d].from_ru]--;
+            if (view.deltas[d].to_ru >= 0)
+                connected[view.deltas[d].to_ru]++;
+        }
+        if (!equal(connected.begin(), connected.end(), view.connected_ues))
+        {
+            cout << "FAIL replaying the connection changes up to tick " << i << " doesn't give its connected_ues" << endl;
+            return false;
+        }
+
+        for (uint32_t u = 0; u < view.header->num_ues; u++)
+        {
+            const TraceNeighbors &ue = view.ue(u, CLOSEST_RUS);
+            if (view.ue_neighbors(u, CLOSEST_RUS)[0].ru != ue.ue_id % NUM_RUS || ue.demand != 10 + ue.ue_id % 5)
+            {
+                cout << "FAIL the closest RUs of UE " << ue.ue_id << " read back wrong" << endl;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+extern int main()
+{
+    vector<WrittenTick> written = write_trace(TRACE_PATH);
+    if (written.empty())
+    {
+        cout << "FAIL unable to write " << TRACE_PATH << endl;
+        return 1;
+    }
+
+    bool ok = check_trace(TRACE_PATH, written);
+    if (ok)
+        cout << "ok   " << written.size() << " ticks read back aligned and as written" << endl;
+
+    // Cut the last block short, as a simulation stopped mid-write would
+    TraceReader reader;
+    reader.open(TRACE_PATH);
+    size_t cut = reader.num_ticks() > 0 ? (const char *)reader.tick(reader.num_ticks() - 1).header - (const char *)&reader.header() + 100 : 0;
+    reader.close();
+    if (truncate(TRACE_PATH, cut) == 0 && reader.open(TRACE_PATH) && reader.num_ticks() == written.size() - 1)
+        cout << "ok   a block cut short is left out" << endl;
+    else
+    {
+        cout << "FAIL a block cut short is not left out" << endl;
+        ok = false;
+    }
+    reader.close();
+    unlink(TRACE_PATH);
+
+    // The stdio buffer hides failed writes until it is flushed, at the latest when the trace is closed
+    if (access("/dev/full", W_OK) == 0)
+    {
+        if (write_trace("/dev/full").empty())
+            cout << "ok   writing to a full disk is reported" << endl;
+        else
+        {
+            cout << "FAIL writing to a full disk is not reported" << endl;
+            ok = false;
+        }
+    }
+
+    cout << (ok ? "PASSED" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,287 @@
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "trace.h"
+
+using namespace std;
+
+// Offsets of the sections of a tick block from its start, each a multiple of 8
+struct BlockLayout
+{
+    size_t p_tot;
+    size_t load;
+    size_t p;
+    size_t alloc_PRB;
+    size_t connected_ues;
+    size_t deltas;
+    size_t neighbors;
+};
+
+static size_t padded(size_t bytes)
+{
+    return (bytes + 7) & ~(size_t)7;
+}
+
+static BlockLayout block_layout(size_t num_rus, size_t num_deltas)
+{
+    BlockLayout layout;
+    layout.p_tot = sizeof(TickHeader);
+    layout.load = layout.p_tot + padded(sizeof(double) * num_rus);
+    layout.p = layout.load + padded(sizeof(float) * num_rus);
+    layout.alloc_PRB = layout.p + padded(sizeof(float) * num_rus);
+    layout.connected_ues = layout.alloc_PRB + padded(sizeof(int32_t) * num_rus);
+    layout.deltas = layout.connected_ues + padded(sizeof(int32_t) * num_rus);
+    layout.neighbors = layout.deltas + padded(sizeof(TraceConnDelta) * num_deltas);
+    return layout;
+}
+
+// ==================
+// TraceWriter
+// ==================
+
+bool TraceWriter::open(const string &path, vector<RU> &rus, int closest_rus, double tick_interval, unsigned int seed)
+{
+    file = fopen(path.c_str(), "wb");
+    if (file == nullptr)
+        return false;
+    setvbuf(file, nullptr, _IOFBF, 1 << 20);
+
+    this->num_rus = rus.size();
+    this->closest_rus = closest_rus;
+    deltas.clear();
+    neighbors.clear();
+    num_ues = 0;
+
+    TraceHeader header = {};
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.num_rus = num_rus;
+    header.closest_rus = closest_rus;
+    header.seed = seed;
+    header.tick_interval = tick_interval;
+    header.header_bytes = sizeof(TraceHeader) + sizeof(TraceRU) * num_rus;
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    for (auto &&ru : rus)
+    {
+        TraceRU trace_ru = {{ru.get_coords()[0], ru.get_coords()[1]}, ru.get_num_PRB(), ru.get_type() == RUType::macro};
+        written = written && fwrite(&trace_ru, sizeof(trace_ru), 1, file) == 1;
+    }
+
+    if (!written)
+    {
+        fclose(file);
+        file = nullptr;
+    }
+    return written;
+}
+
+const bool TraceWriter::is_open()
+{
+    return file != nullptr;
+}
+
+void TraceWriter::connection_changed(int ue_id, int from_ru, int to_ru)
+{
+    if (file != nullptr)
+        deltas.push_back(TraceConnDelta{ue_id, from_ru, to_ru});
+}
+
+void TraceWriter::ue_joined(int ue_id, int demand, const RU_entry *sig_arr)
+{
+    if (file == nullptr)
+        return;
+
+    size_t offset = neighbors.size();
+    neighbors.resize(offset + sizeof(TraceNeighbors) + sizeof(TraceNeighbor) * closest_rus);
+
+    TraceNeighbors ue = {ue_id, demand};
+    memcpy(&neighbors[offset], &ue, sizeof(ue));
+    offset += sizeof(ue);
+
+    for (int i = 0; i < closest_rus; i++)
+    {
+        TraceNeighbor neighbor = {sig_arr[i].ru, sig_arr[i].sig_str};
+        memcpy(&neighbors[offset], &neighbor, sizeof(neighbor));
+        offset += sizeof(neighbor);
+    }
+
+    num_ues++;
+}
+
+/// @brief Copies an array into the block at offset and zeroes the padding after it up to end
+template <typename T>
+static void put(vector<char> &block, size_t offset, size_t end, const T *values, size_t count)
+{
+    memcpy(&block[offset], values, sizeof(T) * count);
+    memset(&block[offset + sizeof(T) * count], 0, end - offset - sizeof(T) * count);
+}
+
+/// @brief Zeroes the padding after a column of num_rus 4-byte values
+static void pad_column(vector<char> &block, size_t offset, size_t end, size_t num_rus)
+{
+    memset(&block[offset + 4 * num_rus], 0, end - offset - 4 * num_rus);
+}
+
+bool TraceWriter::write_tick(long tick_no, double t, vector<RU> &rus, const vector<vector<UEHandle>> &conn,
+                             double total_P, double total_E, int sleeping_RUs)
+{
+    if (file == nullptr)
+        return true;
+
+    BlockLayout layout = block_layout(num_rus, deltas.size());
+    size_t bytes = layout.neighbors + neighbors.size(); // a multiple of 8 like every entry in it
+    if (block.size() < bytes)
+        block.resize(bytes);
+
+    TickHeader header = {bytes, tick_no, t, total_P, total_E, (uint32_t)deltas.size(), num_ues, (uint32_t)sleeping_RUs, 0};
+    memcpy(block.data(), &header, sizeof(header));
+
+    // Columns are filled in place, one pass over the RUs
+    double *p_tot = (double *)&block[layout.p_tot];
+    float *load = (float *)&block[layout.load];
+    float *p = (float *)&block[layout.p];
+    int32_t *alloc_PRB = (int32_t *)&block[layout.alloc_PRB];
+    int32_t *connected_ues = (int32_t *)&block[layout.connected_ues];
+    for (int i = 0; i < num_rus; i++)
+    {
+        p_tot[i] = rus[i].get_p_tot();
+        load[i] = (float)rus[i].get_alloc_PRB() / (float)rus[i].get_num_PRB();
+        p[i] = rus[i].get_p();
+        alloc_PRB[i] = rus[i].get_alloc_PRB();
+        connected_ues[i] = conn[i].size();
+    }
+    pad_column(block, layout.load, layout.p, num_rus);
+    pad_column(block, layout.p, layout.alloc_PRB, num_rus);
+    pad_column(block, layout.alloc_PRB, layout.connected_ues, num_rus);
+    pad_column(block, layout.connected_ues, layout.deltas, num_rus);
+
+    put(block, layout.deltas, layout.neighbors, deltas.data(), deltas.size());
+    put(block, layout.neighbors, bytes, neighbors.data(), neighbors.size());
+
+    deltas.clear();
+    neighbors.clear();
+    num_ues = 0;
+
+    return fwrite(block.data(), bytes, 1, file) == 1;
+}
+
+bool TraceWriter::close()
+{
+    bool closed = file == nullptr || fclose(file) == 0;
+    file = nullptr;
+    return closed;
+}
+
+// ==================
+// TraceReader
+// ==================
+
+TraceReader::~TraceReader()
+{
+    close();
+}
+
+bool TraceReader::open(const string &path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TraceHeader))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping stays valid without the descriptor
+    if (map == MAP_FAILED)
+        return false;
+
+    data = (const char *)map;
+    size = st.st_size;
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    if (memcmp(header().magic, TRACE_MAGIC, sizeof(header().magic)) != 0 || header().version != TRACE_VERSION ||
+        header().header_bytes > size || header().header_bytes % 8 != 0)
+    {
+        close();
+        return false;
+    }
+
+    // Index complete blocks, a block reaching past the end of the file is left out
+    size_t offset = header().header_bytes;
+    while (offset + sizeof(TickHeader) <= size)
+    {
+        const TickHeader *tick = (const TickHeader *)(data + offset);
+        if (tick->block_bytes < sizeof(TickHeader) || tick->block_bytes % 8 != 0 || offset + tick->block_bytes > size)
+            break;
+
+        // The sections must fit in the block for the views handed out by tick to stay inside the mapping
+        size_t ue_bytes = sizeof(TraceNeighbors) + sizeof(TraceNeighbor) * header().closest_rus;
+        if (block_layout(header().num_rus, tick->num_deltas).neighbors + ue_bytes * tick->num_ues > tick->block_bytes)
+            break;
+
+        tick_offsets.push_back(offset);
+        offset += tick->block_bytes;
+    }
+
+    return true;
+}
+
+void TraceReader::close()
+{
+    if (data != nullptr)
+        munmap((void *)data, size);
+    data = nullptr;
+    size = 0;
+    tick_offsets.clear();
+}
+
+const TraceHeader &TraceReader::header()
+{
+    return *(const TraceHeader *)data;
+}
+
+const TraceRU *TraceReader::rus()
+{
+    return (const TraceRU *)(data + sizeof(TraceHeader));
+}
+
+const size_t TraceReader::num_ticks()
+{
+    return tick_offsets.size();
+}
+
+TickView TraceReader::tick(size_t i)
+{
+    const char *block = data + tick_offsets[i];
+
+    TickView view;
+    view.header = (const TickHeader *)block;
+    BlockLayout layout = block_layout(header().num_rus, view.header->num_deltas);
+    view.p_tot = (const double *)(block + layout.p_tot);
+    view.load = (const float *)(block + layout.load);
+    view.p = (const float *)(block + layout.p);
+    view.alloc_PRB = (const int32_t *)(block + layout.alloc_PRB);
+    view.connected_ues = (const int32_t *)(block + layout.connected_ues);
+    view.deltas = (const TraceConnDelta *)(block + layout.deltas);
+    view.neighbors = block + layout.neighbors;
+    return view;
+}
+
+const TraceNeighbors &TickView::ue(int i, int closest_rus)
+{
+    return *(const TraceNeighbors *)(neighbors + i * (sizeof(TraceNeighbors) + sizeof(TraceNeighbor) * closest_rus));
+}
+
+const TraceNeighbor *TickView::ue_neighbors(int i, int closest_rus)
+{
+    return (const TraceNeighbor *)(&ue(i, closest_rus) + 1);
+}
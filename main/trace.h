@@ -0,0 +1,161 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "components.h"
+
+// Binary trace of a simulation run, appended to as the simulation runs and meant to be read through mmap. Values are in
+// the native byte order of the machine that wrote the trace (little-endian on x86-64 and ARM64), so a trace is read on a
+// machine of the same byte order. Every section starts at an offset that is a multiple of 8 and is zero padded up to the
+// next one, so with the file mapped at a page boundary each column can be viewed in place as an array (numpy.frombuffer /
+// a plain pointer cast). The layout is:
+//
+// TraceHeader
+// TraceRU[num_rus]                              static RU info
+// then one block per tick, each made up of:
+//   TickHeader
+//   double  p_tot[num_rus]                      energy consumed by each RU so far (mWs)
+//   float   load[num_rus]                       allocated / available PRBs, then padding
+//   float   p[num_rus]                          current power consumption (mW), then padding
+//   int32_t alloc_PRB[num_rus]                  then padding
+//   int32_t connected_ues[num_rus]              then padding
+//   TraceConnDelta[num_deltas]                  connection changes since the previous block, then padding
+//   TraceNeighbors[num_ues]                     UEs that joined since the previous block, each followed by
+//     TraceNeighbor[closest_rus]                its closest RUs in descending order of signal strength
+//
+// With the padding block_bytes is always a multiple of 8. The first block (tick_no 0) holds the initial connections and
+// UEs. A block whose block_bytes reaches past the end of the file was cut short by the simulation stopping and should be
+// ignored. Version 1 traces had no padding between sections and aren't read
+
+#define TRACE_MAGIC "EETRACE1"
+#define TRACE_VERSION 2
+
+struct TraceHeader
+{
+    char magic[8];       // TRACE_MAGIC, without the terminating null
+    uint32_t version;    // TRACE_VERSION
+    uint32_t num_rus;
+    uint32_t closest_rus;
+    uint32_t seed;
+    double tick_interval; // seconds
+    uint64_t header_bytes; // offset of the first tick block
+};
+
+struct TraceRU
+{
+    float coords[2];
+    int32_t num_PRB;
+    int32_t macro; // 1 for macro-RUs, 0 for micro-RUs
+};
+
+struct TickHeader
+{
+    uint64_t block_bytes; // size of the whole block including this header, the next block starts this many bytes later
+    int64_t tick_no;
+    double t;             // simulation time in seconds
+    double total_P;
+    double total_E;
+    uint32_t num_deltas;
+    uint32_t num_ues;
+    uint32_t sleeping_RUs;
+    uint32_t reserved;
+};
+
+// UE connecting to (from_ru -1), disconnecting from (to_ru -1) or moving between RUs, a handover shows up as a disconnect
+// directly followed by a connect
+struct TraceConnDelta
+{
+    int32_t ue_id;
+    int32_t from_ru;
+    int32_t to_ru;
+};
+
+struct TraceNeighbors
+{
+    int32_t ue_id;
+    int32_t demand;
+};
+
+struct TraceNeighbor
+{
+    int32_t ru;
+    float sig_str;
+};
+
+static_assert(sizeof(TraceHeader) == 40 && sizeof(TraceRU) == 16 && sizeof(TickHeader) == 56 &&
+                  sizeof(TraceConnDelta) == 12 && sizeof(TraceNeighbors) == 8 && sizeof(TraceNeighbor) == 8,
+              "trace layout must not depend on the compiler's padding");
+
+/// @brief Appends simulation state to a trace file, one block per tick. Connection changes and joining UEs are gathered
+/// as they happen and written with the next block. Blocks are built in a reused buffer and written through a large stdio
+/// buffer, so tracing costs about one memcpy per tick
+class TraceWriter
+{
+private:
+    FILE *file = nullptr;
+    int num_rus = 0;
+    int closest_rus = 0;
+    std::vector<char> block;
+    std::vector<TraceConnDelta> deltas;
+    std::vector<char> neighbors; // TraceNeighbors followed by closest_rus TraceNeighbor, per UE
+    uint32_t num_ues = 0;
+
+public:
+    /// @brief Creates the trace file and writes its header
+    /// @return false if the file could not be created or written
+    bool open(const std::string &path, std::vector<RU> &rus, int closest_rus, double tick_interval, unsigned int seed);
+    const bool is_open();
+
+    /// @brief Records a UE connecting to, disconnecting from or moving between RUs, -1 meaning no RU
+    void connection_changed(int ue_id, int from_ru, int to_ru);
+
+    /// @brief Records the closest RUs of a UE that joined the network
+    void ue_joined(int ue_id, int demand, const RU_entry *sig_arr);
+
+    /// @brief Writes a block with the current state of every RU and everything recorded since the previous block
+    /// @return false if the block could not be written, the trace is then incomplete
+    bool write_tick(long tick_no, double t, std::vector<RU> &rus, const std::vector<std::vector<UEHandle>> &conn,
+                    double total_P, double total_E, int sleeping_RUs);
+
+    /// @return false if the buffered blocks could not be written out
+    bool close();
+};
+
+// Views into one tick block of a mapped trace
+struct TickView
+{
+    const TickHeader *header;
+    const double *p_tot;
+    const float *load;
+    const float *p;
+    const int32_t *alloc_PRB;
+    const int32_t *connected_ues;
+    const TraceConnDelta *deltas;
+    const char *neighbors; // header->num_ues entries of variable size, read them with ue and ue_neighbors
+
+    const TraceNeighbors &ue(int i, int closest_rus);
+    const TraceNeighbor *ue_neighbors(int i, int closest_rus);
+};
+
+/// @brief Reads a trace file through mmap, without copying anything out of it. Opening only walks the block headers to
+/// index where each tick starts
+class TraceReader
+{
+private:
+    const char *data = nullptr;
+    size_t size = 0;
+    std::vector<size_t> tick_offsets;
+
+public:
+    ~TraceReader();
+
+    /// @return false if the file can't be mapped or isn't a trace of TRACE_VERSION
+    bool open(const std::string &path);
+    void close();
+
+    const TraceHeader &header();
+    const TraceRU *rus();
+    const size_t num_ticks();
+    TickView tick(size_t i);
+};
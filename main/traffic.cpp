@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "traffic.h"
+#include "sim.h"
+
+using namespace std;
+
+// ======================
+// ArrivalQueue Functions
+// ======================
+
+ArrivalQueue::~ArrivalQueue()
+{
+    take_all(); // frees anything left over
+}
+
+void ArrivalQueue::push(Arrival *arrival)
+{
+    arrival->next = head.load(memory_order_relaxed);
+    while (!head.compare_exchange_weak(arrival->next, arrival, memory_order_release, memory_order_relaxed))
+        ;
+}
+
+vector<unique_ptr<Arrival>> ArrivalQueue::take_all()
+{
+    vector<unique_ptr<Arrival>> arrivals;
+
+    for (Arrival *a = head.exchange(nullptr, memory_order_acquire); a; a = a->next)
+        arrivals.emplace_back(a);
+
+    reverse(arrivals.begin(), arrivals.end()); // stack is newest first
+    return arrivals;
+}
+
+// =======================
+// TrafficSource Functions
+// =======================
+
+TrafficSource::TrafficSource(int id, int num_sources, int first_ue_id, ArrivalQueue *queue)
+{
+    this->id = id;
+    this->num_sources = num_sources;
+    this->first_ue_id = first_ue_id;
+    this->queue = queue;
+
+    seed_seq seq{sim_cfg.seed, (unsigned int)id};
+    this->rng.seed(seq);
+    this->coord_distribution = normal_distribution<float>(sim_cfg.max_coord / 2, sim_cfg.max_coord / 2 / 5);
+}
+
+TrafficSource::~TrafficSource()
+{
+    stop();
+}
+
+void TrafficSource::start(double resume_t, double end_t)
+{
+    thread = std::thread(&TrafficSource::run, this, resume_t, end_t);
+}
+
+void TrafficSource::stop()
+{
+    stopping = true;
+    if (thread.joinable())
+        thread.join();
+}
+
+const double TrafficSource::get_horizon()
+{
+    return horizon.load(memory_order_acquire);
+}
+
+void TrafficSource::run(double resume_t, double end_t)
+{
+    const float max_coord = sim_cfg.max_coord;
+    const int k = sim_cfg.closest_rus;
+    uniform_int_distribution<int> delay_ms(300, 599);
+    uniform_real_distribution<double> lifetime(60, 120);
+
+    double t = delay_ms(rng) / 1000.0;
+    for (long seq = 0; t <= end_t && !stopping; seq++)
+    {
+        // Nothing else will arrive from this source before t
+        horizon.store(t, memory_order_release);
+
+        auto arrival = make_unique<Arrival>();
+        arrival->t = t;
+        arrival->source = id;
+        arrival->seq = seq;
+        arrival->ue_id = first_ue_id + seq * num_sources + id;
+        arrival->coords[0] = fmodf(coord_distribution(rng), max_coord);
+        arrival->coords[1] = fmodf(coord_distribution(rng), max_coord);
+        arrival->lifetime = lifetime(rng);
+        arrival->prb_demand = 2;
+
+        if (t <= resume_t)
+        {
+            t += delay_ms(rng) / 1000.0;
+            continue;
+        }
+
+        // Look up the closest RUs here rather than in the simulation thread, RU positions never change during a run
+        arrival->sig_arr.resize(k);
+        ru_grid.query(arrival->coords, arrival->sig_arr.data(), k);
+
+        // Wait until the arrival is due (realtime), or until the source is no more than a second ahead (event)
+        if (sim_clock.get_mode() == ClockMode::realtime)
+            sim_clock.wait_until(t);
+        else
+            while (t > sim_clock.now() + 1 && !stopping)
+                this_thread::sleep_for(chrono::microseconds(100));
+
+        queue->push(arrival.release());
+        t += delay_ms(rng) / 1000.0;
+    }
+
+    horizon.store(numeric_limits<double>::infinity(), memory_order_release);
+}
+
+// =======================
+// ArrivalIntake Functions
+// =======================
+
+void ArrivalIntake::start(int num_sources, int first_ue_id, double resume_t, double end_t)
+{
+    for (int i = 0; i < num_sources; i++)
+        sources.push_back(make_unique<TrafficSource>(i, num_sources, first_ue_id, &queue));
+
+    for (auto &&source : sources)
+        source->start(resume_t, end_t);
+}
+
+void ArrivalIntake::stop()
+{
+    sources.clear(); // stops and joins each source
+}
+
+vector<unique_ptr<Arrival>> ArrivalIntake::collect(double now)
+{
+    // Every arrival due by now has been pushed once all horizons have passed it
+    for (auto &&source : sources)
+        while (source->get_horizon() <= now)
+            this_thread::yield();
+
+    for (auto &&arrival : queue.take_all())
+        pending.push_back(move(arrival));
+
+    auto order = [](const unique_ptr<Arrival> &a, const unique_ptr<Arrival> &b)
+    { return tie(a->t, a->source, a->seq) < tie(b->t, b->source, b->seq); };
+    sort(pending.begin(), pending.end(), order);
+
+    // Hand over the due arrivals, keeping the rest for later ticks
+    auto not_due = find_if(pending.begin(), pending.end(), [now](const unique_ptr<Arrival> &a)
+                           { return a->t > now; });
+    vector<unique_ptr<Arrival>> due(make_move_iterator(pending.begin()), make_move_iterator(not_due));
+    pending.erase(pending.begin(), not_due);
+
+    return due;
+}
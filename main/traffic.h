@@ -0,0 +1,90 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include "components.h"
+
+// UE arrival produced by a traffic source, admitted into the simulation at the first tick at or after its arrival time
+struct Arrival
+{
+    double t;                      // simulation time of arrival
+    int source;                    // traffic source that produced the arrival
+    long seq;                      // order of the arrival within its source
+    int ue_id;
+    float coords[2];               // x, y coords
+    double lifetime;               // time from arrival until the UE expires
+    int prb_demand;
+    std::vector<RU_entry> sig_arr; // closest RUs, already looked up by the source
+    Arrival *next = nullptr;       // link within the ArrivalQueue
+};
+
+/// @brief Lock-free multi-producer, single-consumer queue of arrivals. Producers push onto a linked stack with a single
+/// compare-and-swap, the consumer takes the whole stack at once, which also rules out ABA problems
+class ArrivalQueue
+{
+private:
+    std::atomic<Arrival *> head{nullptr};
+
+public:
+    ~ArrivalQueue();
+
+    /// @brief Pushes an arrival, can be called from any thread. The queue takes ownership of it
+    void push(Arrival *arrival);
+
+    /// @brief Takes every arrival pushed so far, can only be called from one thread at a time
+    /// @return the taken arrivals, in push order
+    std::vector<std::unique_ptr<Arrival>> take_all();
+};
+
+/// @brief Thread producing UE arrivals 0.3 - 0.6 seconds apart, each with its own seeded random engine so that its arrivals
+/// don't depend on thread timing. Arrivals are pushed no earlier than their arrival time in realtime mode, while in event
+/// mode the source runs up to one second of simulation time ahead of the clock
+class TrafficSource
+{
+private:
+    int id;
+    int num_sources;
+    int first_ue_id;
+    ArrivalQueue *queue;
+    std::default_random_engine rng;
+    std::normal_distribution<float> coord_distribution;
+    std::atomic<double> horizon{0}; // the source won't push any more arrivals with an arrival time before this
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+
+    void run(double resume_t, double end_t);
+
+public:
+    /// @param id the source's index, UE ids are interleaved between sources so that they never collide
+    /// @param num_sources the number of sources in total
+    /// @param first_ue_id the lowest UE id any source may use
+    TrafficSource(int id, int num_sources, int first_ue_id, ArrivalQueue *queue);
+    ~TrafficSource();
+
+    /// @brief Starts producing arrivals up until end_t
+    /// @param resume_t arrivals up until this time are skipped, as they were already admitted before a restored checkpoint.
+    /// The random engine still steps through them, so the arrivals after it are the same as in the original run
+    void start(double resume_t, double end_t);
+    void stop();
+    const double get_horizon();
+};
+
+/// @brief Runs the traffic sources and hands their arrivals to the simulation thread in a reproducible order
+class ArrivalIntake
+{
+private:
+    ArrivalQueue queue;
+    std::vector<std::unique_ptr<TrafficSource>> sources;
+    std::vector<std::unique_ptr<Arrival>> pending; // taken from the queue but not yet due
+
+public:
+    /// @brief Starts num_sources traffic sources that produce arrivals after resume_t until end_t
+    void start(int num_sources, int first_ue_id, double resume_t, double end_t);
+    void stop();
+
+    /// @brief Waits until every source is done with arrivals up to now, then takes all of those arrivals
+    /// @return arrivals due by now, ordered by arrival time, source and sequence number
+    std::vector<std::unique_ptr<Arrival>> collect(double now);
+};
@@ -0,0 +1,70 @@
+"""Decoders for the uid lists the RAN simulator writes to sim_RUs and sim_UEs, in either of its telemetry encodings.
+
+With telemetry_encoding = text the fields are comma separated with a trailing comma ("UE_1,UE_2,"), with compact they
+start with "~" followed by base64 of varints (see main/compact_codec.h for the layout). Both give the same lists:
+
+    split_connections("UE_3,UE_1,")   # ["UE_3", "UE_1"]
+    split_connections("~AQI")         # ["UE_1", "UE_3"], compact connections are sorted by id
+    split_near_rus(latest_ue_entry["near_RU"][0])
+"""
+import base64
+
+COMPACT_MARKER = "~"
+
+
+def _bytes(value):
+    payload = value[1:]
+    return base64.b64decode(payload + "=" * (-len(payload) % 4))
+
+
+def _varints(data):
+    values, value, shift = [], 0, 0
+    for byte in data:
+        value |= (byte & 0x7f) << shift
+        shift += 7
+        if not byte & 0x80:
+            values.append(value)
+            value, shift = 0, 0
+    return values
+
+
+def decode_id_set(value):
+    ids, id = [], 0
+    for delta in _varints(_bytes(value)):
+        id += delta
+        ids.append(id)
+    return ids
+
+
+def decode_id_list(value):
+    ids, id = [], 0
+    for delta in _varints(_bytes(value)):
+        id += (delta >> 1) ^ -(delta & 1)  # zigzag
+        ids.append(id)
+    return ids
+
+
+def decode_sig_strs(value):
+    data = _bytes(value)
+    return [(data[i] | data[i + 1] << 8) / 65535 for i in range(0, len(data) - 1, 2)]
+
+
+def split_connections(value):
+    """UE uids of an RU's connections field"""
+    if value.startswith(COMPACT_MARKER):
+        return ["UE_" + str(id) for id in decode_id_set(value)]
+    return value.split(",")[:-1]
+
+
+def split_near_rus(value):
+    """RU uids of a UE's near_RU field, closest first"""
+    if value.startswith(COMPACT_MARKER):
+        return ["RU_" + str(id) for id in decode_id_list(value)]
+    return value.split(",")[:-1]
+
+
+def split_sig_strs(value):
+    """Signal strengths of a UE's near_RU_sig field, in the same order as its near_RU field"""
+    if value.startswith(COMPACT_MARKER):
+        return decode_sig_strs(value)
+    return [float(sig_str) for sig_str in value.split(",")[:-1]]
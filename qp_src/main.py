@@ -36,6 +36,7 @@ from prediction import forecast
 from qptrain import train
 from database import DATABASE, DUMMY
 from exceptions import DataNotMatchError
+from compact import split_connections, split_near_rus
 import warnings
 # import schedule
 warnings.filterwarnings("ignore")
@@ -141,9 +142,9 @@ def predict_handovers(payload):
             conn_list = latest_ru_entry["connections"][0] # gather string containing all connected UEs
 
             if (conn_list is not None):
-                # If RU has connected UEs, split into array, removing last entry since it will be an empty string
-                # conn_list will look like "UE_1,UE_2,UE_3,"
-                conn_list = conn_list.split(",")[:-1]
+                # If RU has connected UEs, split into array of uids
+                # conn_list will look like "UE_1,UE_2,UE_3," or be compact encoded, see compact.py
+                conn_list = split_connections(conn_list)
 
                 # loop through and gather data on each UE to find closest RUs
                 for ue in conn_list:
@@ -151,8 +152,8 @@ def predict_handovers(payload):
                     latest_ue_entry = db.data.tail(1) # only interested in last entry (most recent UE status report)
 
                     # latest_ue_entry["near_RU"][0] will look like "RU_52,RU_51,RU_62,RU_42,RU_53,RU_61,RU_41,RU_63,RU_43,RU_50,"
-                    # take string defining all known RUs and split it into list, excluding last element (blank string)
-                    known_ru_list = latest_ue_entry["near_RU"][0].split(",")[:-1]
+                    # take string defining all known RUs and split it into list
+                    known_ru_list = split_near_rus(latest_ue_entry["near_RU"][0])
 
                     for known_ru in known_ru_list:
                         if known_ru in list(ru_fame_dict.keys()):
@@ -177,9 +178,9 @@ def predict_handovers(payload):
             conn_list = latest_ru_entry["connections"][0] # gather string containing all connected UEs
 
             if (conn_list is not None):
-                # If RU has connected UEs, split into array, removing last entry since it will be an empty string
-                # conn_list will look like "UE_1,UE_2,UE_3,"
-                conn_list = conn_list.split(",")[:-1]
+                # If RU has connected UEs, split into array of uids
+                # conn_list will look like "UE_1,UE_2,UE_3," or be compact encoded, see compact.py
+                conn_list = split_connections(conn_list)
 
                 sleep_possible = True
                 potential_handovers = {}
@@ -187,7 +188,7 @@ def predict_handovers(payload):
                     db.read_ue_data(ue)
                     latest_ue_entry = db.data.tail(1) # only interested in last entry (most recent UE status report)
 
-                    known_ru_list = latest_ue_entry["near_RU"][0].split(",")[:-1]
+                    known_ru_list = split_near_rus(latest_ue_entry["near_RU"][0])
 
                     # for each connected UE, iterate through all known RUs that are not the current RU and are not in sleep_targets
                     for known_ru in known_ru_list:
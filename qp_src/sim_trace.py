@@ -0,0 +1,83 @@
+"""Zero-copy reader for the binary traces written by the RAN simulator (--trace-file), see main/trace.h for the layout.
+Traces are in the byte order of the machine that wrote them and are read in the byte order of this one.
+
+The file is memory mapped and every column is returned as a numpy view into the mapping, so nothing is read from disk
+until it is used and nothing is copied:
+
+    trace = SimTrace("run.trace")
+    for tick in trace:
+        tick["load"]      # float32 array with one entry per RU
+        tick["deltas"]    # structured array of (ue_id, from_ru, to_ru)
+    trace.column("p")     # (num_ticks, num_rus) array of one column over the whole run, built from strided views
+"""
+import numpy as np
+
+HEADER = np.dtype([("magic", "S8"), ("version", "=u4"), ("num_rus", "=u4"), ("closest_rus", "=u4"), ("seed", "=u4"),
+                   ("tick_interval", "=f8"), ("header_bytes", "=u8")])
+RU = np.dtype([("coords", "=f4", 2), ("num_PRB", "=i4"), ("macro", "=i4")])
+TICK = np.dtype([("block_bytes", "=u8"), ("tick_no", "=i8"), ("t", "=f8"), ("total_P", "=f8"), ("total_E", "=f8"),
+                 ("num_deltas", "=u4"), ("num_ues", "=u4"), ("sleeping_RUs", "=u4"), ("reserved", "=u4")])
+DELTA = np.dtype([("ue_id", "=i4"), ("from_ru", "=i4"), ("to_ru", "=i4")])
+VERSION = 2
+
+
+def padded(nbytes):
+    """Every section of a tick block is zero padded to a multiple of 8 bytes"""
+    return (nbytes + 7) & ~7
+
+
+class SimTrace(object):
+
+    def __init__(self, path):
+        self.data = np.memmap(path, dtype=np.uint8, mode="r")
+        self.header = np.frombuffer(self.data, HEADER, count=1)[0]
+        if self.header["magic"] != b"EETRACE1":
+            raise ValueError("{} is not a simulator trace".format(path))
+        if self.header["version"] != VERSION:
+            raise ValueError("{} is a version {} trace, only version {} is read".format(path, self.header["version"], VERSION))
+
+        self.num_rus = int(self.header["num_rus"])
+        self.closest_rus = int(self.header["closest_rus"])
+        self.rus = np.frombuffer(self.data, RU, count=self.num_rus, offset=HEADER.itemsize)
+
+        # each joining UE is stored as (ue_id, demand) followed by closest_rus pairs of (ru, sig_str)
+        self.ue_entry = np.dtype([("ue_id", "=i4"), ("demand", "=i4"), ("near", [("ru", "=i4"), ("sig_str", "=f4")], self.closest_rus)])
+
+        # index complete blocks, a block cut short at the end of the file is left out
+        self.offsets = []
+        offset = int(self.header["header_bytes"])
+        while offset + TICK.itemsize <= len(self.data):
+            size = int(np.frombuffer(self.data, "=u8", count=1, offset=offset)[0])
+            if size < TICK.itemsize or size % 8 != 0 or offset + size > len(self.data):
+                break
+            self.offsets.append(offset)
+            offset += size
+
+    def __len__(self):
+        return len(self.offsets)
+
+    def __iter__(self):
+        for i in range(len(self)):
+            yield self[i]
+
+    def __getitem__(self, i):
+        offset = self.offsets[i]
+        n = self.num_rus
+        header = np.frombuffer(self.data, TICK, count=1, offset=offset)[0]
+        offset += TICK.itemsize
+
+        tick = {"header": header}
+        for name, dtype in (("p_tot", "=f8"), ("load", "=f4"), ("p", "=f4"), ("alloc_PRB", "=i4"), ("connected_ues", "=i4")):
+            tick[name] = np.frombuffer(self.data, dtype, count=n, offset=offset)
+            offset += padded(tick[name].nbytes)
+
+        tick["deltas"] = np.frombuffer(self.data, DELTA, count=int(header["num_deltas"]), offset=offset)
+        offset += padded(tick["deltas"].nbytes)
+
+        tick["ues"] = np.frombuffer(self.data, self.ue_entry, count=int(header["num_ues"]), offset=offset)
+        return tick
+
+    def column(self, name):
+        """Stacks one RU column of every tick into a (num_ticks, num_rus) array. Blocks only have the same size when no
+        UEs joined or connections changed, so this copies, use indexing or iteration to stay zero-copy"""
+        return np.stack([self[i][name] for i in range(len(self))])
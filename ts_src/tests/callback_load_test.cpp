@@ -0,0 +1,133 @@
+/*
+  Load test for running the TS-xApp callbacks on several RMR worker threads
+  (ts_rmr_threads). ts_xapp.cpp is compiled as is, against the stand-ins in
+  stubs/ for RMR, xapp-frame, rapidjson, the REST client and the generated
+  gRPC stub, so it builds and runs outside the RIC platform.
+
+  The first part queues a mix of A1 policy, HP handover and TM situation
+  messages and runs them through the xApp's own main with 1 to 8 threads.
+  The second part sends HandOff requests from as many threads at once,
+  the way callbacks issuing control requests would, to a control endpoint
+  that takes a millisecond to answer. Both check that nothing is lost or
+  duplicated: every message is handled, every HandOff gets a distinct
+  seqNo, and no more REST clients are created than the pool holds.
+
+  Build and run from ts_src/tests with
+
+    mkdir -p gen && protoc -Istubs/protobuf --cpp_out=gen stubs/protobuf/rc.proto
+    g++ -std=c++17 -O2 -Istubs -Igen -o callback_load_test callback_load_test.cpp gen/rc.pb.cc \
+        $(pkg-config --libs grpc++ protobuf) -lpthread
+    ./callback_load_test
+*/
+#define main ts_xapp_main
+#include "../ts_xapp.cpp"
+#undef main
+
+#define NUM_MESSAGES 30000
+#define NUM_HANDOFFS 2000
+#define ENDPOINT_LATENCY_US 1000
+
+static const int thread_counts[] = { 1, 2, 4, 8 };
+
+static double seconds_since( chrono::steady_clock::time_point start ) {
+  return chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+}
+
+// one A1 policy, HP handover list and TM situation list after the other, the policies setting thresholds 1, 2, 3...
+static void queue_messages() {
+  string handovers = "{";
+  string situations = "[";
+  for( int i = 0; i < 20; i++ ) {
+    handovers += string( i > 0 ? ", " : "" ) + "\"UE_" + to_string( i ) + "\": \"RU_" + to_string( i ) + ",RU_" + to_string( i + 1 ) + "\"";
+    situations += string( i > 0 ? ", " : "" ) + "{\"uid\": \"RU_" + to_string( i ) + "\", \"sit\": \"LOW_TRAFFIC\"}";
+  }
+  handovers += "}";
+  situations += "]";
+
+  for( int i = 0; i < NUM_MESSAGES / 3; i++ ) {
+    Xapp::Inject( A1_POLICY_REQ, "{\"operation\": \"CREATE\", \"policy_type_id\": 20008, \"policy_instance_id\": \"tsapolicy145\", "
+                                 "\"payload\": {\"threshold\": " + to_string( i + 1 ) + "}}" );
+    Xapp::Inject( HP_HANDOVERS, handovers );
+    Xapp::Inject( TM_SIT_FOUND, situations );
+  }
+}
+
+// runs the queued messages through the xApp's main, returns false if any went missing
+static bool run_callbacks( int threads ) {
+  Config::Set( "ts_rmr_threads", to_string( threads ) );
+  queue_messages();
+  long sent_before = Message::sent;
+
+  auto start = chrono::steady_clock::now();
+  ts_xapp_main( 0, nullptr );
+  double elapsed = seconds_since( start );
+
+  long sent = Message::sent - sent_before;
+  int threshold = downlink_threshold.load();
+  bool ok = sent == NUM_MESSAGES / 3 * 2 && threshold >= 1 && threshold <= NUM_MESSAGES / 3;
+
+  cerr << ( ok ? "ok   " : "FAIL " ) << threads << " RMR threads: " << NUM_MESSAGES << " messages in " << elapsed << " s, "
+       << NUM_MESSAGES / elapsed << " per second, " << sent << " forwarded" << endl;
+  return ok;
+}
+
+// sends HandOffs from several threads at once, returns false if any seqNo was repeated or the pool was exceeded
+static bool run_handoffs( int threads ) {
+  mutex mtx;
+  vector<unsigned int> seqs;
+  restclient::Endpoint::post = [&]( const string &path, const string &body ) {
+    unsigned int seq = stoul( body.substr( body.find( "\"seqNo\":" ) + 8 ) );
+    this_thread::sleep_for( chrono::microseconds( ENDPOINT_LATENCY_US ) );
+    lock_guard<mutex> lock( mtx );
+    seqs.push_back( seq );
+    return restclient::response_t{ 200, "{\"status\": \"ok\"}" };
+  };
+
+  int pool_size = 8;
+  rest_pool.reset( new RestClientPool( ts_control_ep, pool_size ) );
+  long clients_before = restclient::Endpoint::clients;
+  atomic<int> next{0};
+
+  auto start = chrono::steady_clock::now();
+  vector<thread> senders;
+  for( int t = 0; t < threads; t++ ) {
+    senders.emplace_back( [&] {
+      for( int i = next++; i < NUM_HANDOFFS; i = next++ ) {
+        send_rest_control_request( to_string( i ), "CID1", "CID2" );
+      }
+    } );
+  }
+  for( thread &t : senders ) {
+    t.join();
+  }
+  double elapsed = seconds_since( start );
+
+  long clients = restclient::Endpoint::clients - clients_before;
+  sort( seqs.begin(), seqs.end() );
+  bool unique = adjacent_find( seqs.begin(), seqs.end() ) == seqs.end();
+  bool ok = seqs.size() == NUM_HANDOFFS && unique && clients <= pool_size;
+
+  cerr << ( ok ? "ok   " : "FAIL " ) << threads << " sending threads: " << NUM_HANDOFFS << " HandOffs in " << elapsed << " s, "
+       << NUM_HANDOFFS / elapsed << " per second, " << clients << " clients, seqNos " << ( unique ? "distinct" : "REPEATED" ) << endl;
+  return ok;
+}
+
+extern int main() {
+  Config::Set( "ts_control_api", "rest" );
+  Config::Set( "ts_control_ep", "http://127.0.0.1:5000/api/echo" );
+
+  // the callbacks log every message, which would only measure the terminal
+  streambuf *out = cout.rdbuf( nullptr );
+
+  bool ok = true;
+  for( int threads : thread_counts ) {
+    ok = run_callbacks( threads ) && ok;
+  }
+  for( int threads : thread_counts ) {
+    ok = run_handoffs( threads ) && ok;
+  }
+
+  cout.rdbuf( out );
+  cerr << ( ok ? "PASSED" : "FAILED" ) << endl;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,308 @@
+/*
+  Parse throughput of the TS-xApp's SAX handlers, one message type at a
+  time: A1 policies, AD anomaly lists, TM traffic situations, HP handovers,
+  QP predictions, and the E2 manager's nodeb list and nodeb replies.
+  ts_xapp.cpp is compiled as is against the stand-ins in stubs/, like
+  callback_load_test.cpp.
+
+  Each payload is parsed once to record the SAX events the reader sends.
+  Replaying those events into a fresh handler per message measures the
+  handlers alone, which is what the key tables changed, and is compared
+  against a handler that keeps the key as a string and picks fields with
+  compare chains, the way the handlers used to. The nodeb handler also
+  base64 decodes its request part and searches it for cells, which the
+  string key handler doesn't, so only its ns/key column compares like
+  with like. HP handovers and QP predictions have UE and cell ids for keys
+  and keep them as strings. The full parse through
+  parse_payload is timed as well, but with the stand-in reader rather than
+  rapidjson, so its MB/s only shows where the handler cost sits relative
+  to tokenizing. A payload with nil padding must parse, and one with data
+  after an embedded nil must not.
+
+  Build and run from ts_src/tests with
+
+    mkdir -p gen && protoc -Istubs/protobuf --cpp_out=gen stubs/protobuf/rc.proto
+    g++ -std=c++17 -O2 -Istubs -Igen -o parse_bench parse_bench.cpp gen/rc.pb.cc \
+        $(pkg-config --libs grpc++ protobuf) -lpthread
+    ./parse_bench
+*/
+#define main ts_xapp_main
+#include "../ts_xapp.cpp"
+#undef main
+
+#include <iomanip>
+
+#define MIN_SECONDS 0.2  // each measurement repeats until it has run at least this long
+
+// one SAX call of the reader, with the string it passed for keys and string values
+struct SaxEvent {
+  enum Type { null, boolean, int32, uint32, int64, uint64, real, string_value, key, start_object, end_object, start_array, end_array };
+
+  Type type;
+  int64_t i = 0;
+  uint64_t u = 0;
+  double d = 0;
+  SizeType count = 0;
+  string str;
+};
+
+struct SaxRecorder : public BaseReaderHandler<UTF8<>, SaxRecorder> {
+  vector<SaxEvent> events;
+
+  void add( SaxEvent::Type type ) { events.emplace_back(); events.back().type = type; }
+
+  bool Null() { add( SaxEvent::null ); return true; }
+  bool Bool( bool b ) { add( SaxEvent::boolean ); events.back().u = b; return true; }
+  bool Int( int i ) { add( SaxEvent::int32 ); events.back().i = i; return true; }
+  bool Uint( unsigned u ) { add( SaxEvent::uint32 ); events.back().u = u; return true; }
+  bool Int64( int64_t i ) { add( SaxEvent::int64 ); events.back().i = i; return true; }
+  bool Uint64( uint64_t u ) { add( SaxEvent::uint64 ); events.back().u = u; return true; }
+  bool Double( double d ) { add( SaxEvent::real ); events.back().d = d; return true; }
+  bool String( const char *str, SizeType length, bool copy ) { add( SaxEvent::string_value ); events.back().str.assign( str, length ); return true; }
+  bool Key( const char *str, SizeType length, bool copy ) { add( SaxEvent::key ); events.back().str.assign( str, length ); return true; }
+  bool StartObject() { add( SaxEvent::start_object ); return true; }
+  bool EndObject( SizeType count ) { add( SaxEvent::end_object ); events.back().count = count; return true; }
+  bool StartArray() { add( SaxEvent::start_array ); return true; }
+  bool EndArray( SizeType count ) { add( SaxEvent::end_array ); events.back().count = count; return true; }
+};
+
+template <typename Handler>
+static bool replay( const vector<SaxEvent> &events, Handler &handler ) {
+  bool ok = true;
+  for( const SaxEvent &e : events ) {
+    switch( e.type ) {
+      case SaxEvent::null: ok = handler.Null(); break;
+      case SaxEvent::boolean: ok = handler.Bool( e.u != 0 ); break;
+      case SaxEvent::int32: ok = handler.Int( (int) e.i ); break;
+      case SaxEvent::uint32: ok = handler.Uint( (unsigned) e.u ); break;
+      case SaxEvent::int64: ok = handler.Int64( e.i ); break;
+      case SaxEvent::uint64: ok = handler.Uint64( e.u ); break;
+      case SaxEvent::real: ok = handler.Double( e.d ); break;
+      case SaxEvent::string_value: ok = handler.String( e.str.c_str(), (SizeType) e.str.size(), true ); break;
+      case SaxEvent::key: ok = handler.Key( e.str.c_str(), (SizeType) e.str.size(), true ); break;
+      case SaxEvent::start_object: ok = handler.StartObject(); break;
+      case SaxEvent::end_object: ok = handler.EndObject( e.count ); break;
+      case SaxEvent::start_array: ok = handler.StartArray(); break;
+      case SaxEvent::end_array: ok = handler.EndArray( e.count ); break;
+    }
+    if( !ok ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+  The handlers as they were before the key tables: every key is copied into
+  curr_key and the fields of interest are found by comparing it against each
+  of their names in turn. String values under those fields are kept, the
+  rest are dropped.
+*/
+struct StringKeyHandler : public BaseReaderHandler<UTF8<>, StringKeyHandler> {
+  const vector<string> *fields;
+  vector<string> values;
+  string curr_key = "";
+
+  bool String( const char *str, SizeType length, bool copy ) {
+    for( const string &field : *fields ) {
+      if( curr_key.compare( field ) == 0 ) {
+        values.push_back( str );
+        break;
+      }
+    }
+    return true;
+  }
+  bool Key( const char *str, SizeType length, bool copy ) {
+    curr_key = str;
+    return true;
+  }
+};
+
+struct MessageType {
+  string name;
+  string payload;
+  vector<string> fields;  // keys the handler picks values from, for StringKeyHandler, empty where keys are data
+
+  // replays the recorded events into a fresh handler
+  size_t ( *handle )( const vector<SaxEvent> &events );
+  // parses the payload through parse_payload into a fresh handler
+  bool ( *parse )( const string &payload );
+};
+
+template <typename Handler>
+static size_t handle_with( const vector<SaxEvent> &events ) {
+  Handler handler;
+  replay( events, handler );
+  return sizeof( handler );
+}
+
+template <typename Handler>
+static bool parse_with( const string &payload ) {
+  Handler handler;
+  Msg_component component( (unsigned char *) payload.data() );
+  return parse_payload( component, payload.size(), handler );
+}
+
+static string a1_policy() {
+  return "{\"operation\": \"CREATE\", \"policy_type_id\": 20008, \"policy_instance_id\": \"tsapolicy145\", \"payload\": {\"threshold\": 5}}";
+}
+
+static string anomaly_list( int ues ) {
+  string json = "[";
+  for( int i = 0; i < ues; i++ ) {
+    json += string( i > 0 ? ", " : "" ) + "{\"du-id\": 1010, \"ue-id\": \"Train passenger " + to_string( i ) +
+            "\", \"measTimeStampRf\": 1620835470108, \"Degradation\": \"RSRP RSSINR\"}";
+  }
+  return json + "]";
+}
+
+static string traffic_situations( int rus ) {
+  string json = "[";
+  for( int i = 0; i < rus; i++ ) {
+    json += string( i > 0 ? ", " : "" ) + "{\"uid\": \"RU_" + to_string( i ) + "\", \"sit\": \"LOW_TRAFFIC\"}";
+  }
+  return json + "]";
+}
+
+static string handovers( int ues ) {
+  string json = "{";
+  for( int i = 0; i < ues; i++ ) {
+    json += string( i > 0 ? ", " : "" ) + "\"UE_" + to_string( i ) + "\": \"RU_" + to_string( i ) + ",RU_" + to_string( i + 1 ) + "\"";
+  }
+  return json + "}";
+}
+
+static string prediction( int cells ) {
+  string json = "{\"Car-1\": {";
+  for( int i = 0; i < cells; i++ ) {
+    json += string( i > 0 ? ", " : "" ) + "\"c" + to_string( i ) + "/B" + to_string( 10 + i ) + "\": [" +
+            to_string( 50000 - i * 1000 ) + ", " + to_string( 40000 - i * 1000 ) + "]";
+  }
+  return json + "}}";
+}
+
+static string nodeb_list( int nodebs ) {
+  string json = "[";
+  for( int i = 0; i < nodebs; i++ ) {
+    json += string( i > 0 ? ", " : "" ) + "{\"inventoryName\": \"gnb_734_733_b5c677" + to_string( 10 + i ) +
+            "\", \"globalNbId\": {\"plmnId\": \"373437\", \"nbId\": \"10110101110001100111011110001\"}, \"connectionStatus\": \"CONNECTED\"}";
+  }
+  return json + "]";
+}
+
+// an E2 manager nodeb reply, the request part holding two cells of the nodeb in base64
+static string nodeb() {
+  return "{\"ranName\": \"gnb_734_733_b5c67788\", \"connectionStatus\": \"CONNECTED\", "
+         "\"globalNbId\": {\"plmnId\": \"373437\", \"nbId\": \"10110101110001100111011110001\"}, \"nodeType\": \"GNB\", "
+         "\"gnb\": {\"ranFunctions\": [{\"ranFunctionId\": 1, \"ranFunctionRevision\": 1, \"ranFunctionOid\": \"1.3.6.1.4.1.53148.1.1.2.2\"}], "
+         "\"gnbType\": \"GNB\", \"nodeConfigs\": [{\"e2nodeComponentInterfaceTypeNG\": {\"amfName\": \"nginterf\"}, "
+         "\"e2nodeComponentInterfaceType\": \"ng\", \"e2nodeComponentRequestPart\": "
+         "\"ACBOR1NldHVwUmVxdWVzdCBnbmJfNzM0XzczM19iNWM2Nzc4OCBCNUM2Nzc4OEFCMSB0YWM9MSBCNUM2Nzc4OEFDMiBtY2M9NzM0IG1uYz03MzMgc2xpY2VTdXBwb3J0\", "
+         "\"e2nodeComponentResponsePart\": \"IBUAAAEANAAvAAAAAQAAAGFtZg==\"}]}, "
+         "\"associatedE2tInstanceAddress\": \"10.244.0.29:38000\", \"setupFromNetwork\": true}";
+}
+
+static vector<MessageType> message_types() {
+  return {
+    { "A1 policy", a1_policy(), { "policy_type_id", "policy_instance_id", "threshold", "operation" },
+      handle_with<PolicyHandler>, parse_with<PolicyHandler> },
+    { "AD anomalies (10 UEs)", anomaly_list( 10 ), { "ue-id" },
+      handle_with<AnomalyHandler>, parse_with<AnomalyHandler> },
+    { "TM situations (50 RUs)", traffic_situations( 50 ), { "uid" },
+      handle_with<TrafficSituationHandler>, parse_with<TrafficSituationHandler> },
+    { "HP handovers (20 UEs)", handovers( 20 ), {},
+      handle_with<HandoverHandler>, parse_with<HandoverHandler> },
+    { "QP prediction (8 cells)", prediction( 8 ), {},
+      handle_with<PredictionHandler>, parse_with<PredictionHandler> },
+    { "E2 nodeb list (10)", nodeb_list( 10 ), { "inventoryName" },
+      handle_with<NodebListHandler>, parse_with<NodebListHandler> },
+    { "E2 nodeb", nodeb(), { "ranName", "plmnId", "nbId", "e2nodeComponentRequestPart" },
+      handle_with<NodebHandler>, parse_with<NodebHandler> },
+  };
+}
+
+// payloads bounded by their length: nil padding after the document is accepted, anything after an embedded nil is not
+static bool check_framing() {
+  string situations = traffic_situations( 2 );
+  struct { const char *name; string payload; bool parses; } cases[] = {
+    { "unpadded", situations, true },
+    { "nil padded", situations + string( 3, '\0' ), true },
+    { "data after a nil", situations + string( 1, '\0' ) + traffic_situations( 1 ), false },
+    { "data after nil padding", situations + string( 2, '\0' ) + "x", false },
+  };
+
+  bool ok = true;
+  for( const auto &c : cases ) {
+    if( parse_with<TrafficSituationHandler>( c.payload ) != c.parses ) {
+      cerr << "FAIL a payload " << c.name << ( c.parses ? " does not parse" : " parses" ) << endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+// runs f in batches until MIN_SECONDS have passed, returns nanoseconds per call
+template <typename F>
+static double time_per_call( F f ) {
+  long calls = 0;
+  auto start = chrono::steady_clock::now();
+  double elapsed;
+  do {
+    for( int i = 0; i < 1000; i++ ) {
+      f();
+    }
+    calls += 1000;
+    elapsed = chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+  } while( elapsed < MIN_SECONDS );
+  return elapsed * 1e9 / calls;
+}
+
+extern int main() {
+  volatile size_t sink = 0;  // keeps the optimizer from dropping the handlers' work
+  bool ok = true;
+
+  // the callbacks log every message, which would only measure the terminal
+  streambuf *out = cout.rdbuf( nullptr );
+
+  cerr << left << setw( 26 ) << "message" << right << setw( 7 ) << "bytes" << setw( 6 ) << "keys"
+       << setw( 13 ) << "handler ns" << setw( 12 ) << "ns/key" << setw( 14 ) << "string keys"
+       << setw( 12 ) << "ns/key" << setw( 12 ) << "parse ns" << setw( 9 ) << "MB/s" << endl;
+
+  for( const MessageType &type : message_types() ) {
+    SaxRecorder recorder;
+    Reader reader;
+    StringStream ss( type.payload.c_str() );
+    if( !reader.Parse( ss, recorder ) || !type.parse( type.payload ) ) {
+      cerr << "FAIL " << type.name << " does not parse" << endl;
+      ok = false;
+      continue;
+    }
+    const vector<SaxEvent> &events = recorder.events;
+    long keys = count_if( events.begin(), events.end(), []( const SaxEvent &e ) { return e.type == SaxEvent::key; } );
+
+    double handler_ns = time_per_call( [&] { sink = sink + type.handle( events ); } );
+    double parse_ns = time_per_call( [&] { sink = sink + type.parse( type.payload ); } );
+
+    cerr << left << setw( 26 ) << type.name << right << setw( 7 ) << type.payload.size() << setw( 6 ) << keys
+         << fixed << setprecision( 0 ) << setw( 13 ) << handler_ns << setprecision( 1 ) << setw( 12 ) << handler_ns / keys;
+    if( type.fields.empty() ) {
+      cerr << setw( 14 ) << "-" << setw( 12 ) << "-";  // keys are UE and cell ids, these handlers keep them as strings
+    } else {
+      double string_ns = time_per_call( [&] {
+        StringKeyHandler handler;
+        handler.fields = &type.fields;
+        replay( events, handler );
+        sink = sink + handler.values.size();
+      } );
+      cerr << setprecision( 0 ) << setw( 14 ) << string_ns << setprecision( 1 ) << setw( 12 ) << string_ns / keys;
+    }
+    cerr << setprecision( 0 ) << setw( 12 ) << parse_ns << setprecision( 1 ) << setw( 9 ) << type.payload.size() * 1e3 / parse_ns << endl;
+    cerr.unsetf( ios::fixed );
+  }
+
+  ok = check_framing() && ok;
+
+  cout.rdbuf( out );
+  cerr << ( ok ? "PASSED" : "FAILED" ) << endl;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,47 @@
+/*
+  Stand-in for the rc.grpc.pb.h that grpc_cpp_plugin generates from rc.proto,
+  with just the client stub ts_xapp.cpp uses, written the way the plugin
+  writes it. The messages come from rc.pb.h, generated by protoc.
+*/
+#pragma once
+#include <memory>
+#include <grpcpp/channel.h>
+#include <grpcpp/client_context.h>
+#include <grpcpp/completion_queue.h>
+#include <grpcpp/impl/codegen/proto_utils.h>
+#include <grpcpp/impl/codegen/rpc_method.h>
+#include <grpcpp/support/async_unary_call.h>
+#include <grpcpp/support/stub_options.h>
+#include "rc.pb.h"
+
+namespace rc {
+
+class MsgComm final {
+  public:
+    class Stub final {
+      private:
+        std::shared_ptr<::grpc::ChannelInterface> channel_;
+        const ::grpc::internal::RpcMethod rpcmethod_SendRICControlReqServiceGrpc_;
+
+      public:
+        Stub( const std::shared_ptr<::grpc::ChannelInterface> &channel, const ::grpc::StubOptions &options = ::grpc::StubOptions() ) :
+          channel_( channel ),
+          rpcmethod_SendRICControlReqServiceGrpc_( "/rc.MsgComm/SendRICControlReqServiceGrpc", options.suffix_for_stats(),
+                                                   ::grpc::internal::RpcMethod::NORMAL_RPC, channel ) {}
+
+        std::unique_ptr<::grpc::ClientAsyncResponseReader<::rc::RicControlGrpcRsp>> PrepareAsyncSendRICControlReqServiceGrpc(
+            ::grpc::ClientContext *context, const ::rc::RicControlGrpcReq &request, ::grpc::CompletionQueue *cq ) {
+          return std::unique_ptr<::grpc::ClientAsyncResponseReader<::rc::RicControlGrpcRsp>>(
+              ::grpc::internal::ClientAsyncResponseReaderHelper::Create<::rc::RicControlGrpcRsp, ::rc::RicControlGrpcReq,
+                                                                        ::grpc::protobuf::MessageLite, ::grpc::protobuf::MessageLite>(
+                  channel_.get(), cq, rpcmethod_SendRICControlReqServiceGrpc_, context, request ) );
+        }
+    };
+
+    static std::unique_ptr<Stub> NewStub( const std::shared_ptr<::grpc::ChannelInterface> &channel,
+                                          const ::grpc::StubOptions &options = ::grpc::StubOptions() ) {
+      return std::unique_ptr<Stub>( new Stub( channel, options ) );
+    }
+};
+
+}  // namespace rc
@@ -0,0 +1,37 @@
+/*
+  Stand-in for rapidjson's Document, see reader.h. It keeps the parsed text
+  rather than a DOM, and Accept replays it to a handler through the Reader.
+*/
+#pragma once
+#include <string>
+#include "reader.h"
+
+namespace rapidjson {
+
+class Document {
+  private:
+    std::string json;
+    bool error = false;
+
+    // only checks that the text parses
+    struct Validator : public BaseReaderHandler<UTF8<>, Validator> {};
+
+  public:
+    Document &Parse( const char *str ) {
+      json = str;
+      Validator validator;
+      StringStream ss( json.c_str() );
+      error = !Reader().Parse( ss, validator );
+      return *this;
+    }
+
+    bool HasParseError() const { return error; }
+
+    template <typename Handler>
+    bool Accept( Handler &handler ) const {
+      StringStream ss( json.c_str() );
+      return !error && Reader().Parse( ss, handler );
+    }
+};
+
+}  // namespace rapidjson
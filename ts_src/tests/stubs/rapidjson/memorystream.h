@@ -0,0 +1,3 @@
+// Stand-in for rapidjson/memorystream.h, everything the harnesses need is in reader.h and document.h
+#pragma once
+#include "document.h"
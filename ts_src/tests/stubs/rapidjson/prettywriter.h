@@ -0,0 +1,15 @@
+// Stand-in for rapidjson's PrettyWriter, see writer.h
+#pragma once
+#include "writer.h"
+
+namespace rapidjson {
+
+template <typename OutputStream>
+class PrettyWriter : public Writer<OutputStream> {
+  public:
+    PrettyWriter( OutputStream &os ) : Writer<OutputStream>( os ) {
+      this->indent = 4;
+    }
+};
+
+}  // namespace rapidjson
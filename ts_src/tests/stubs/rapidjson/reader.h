@@ -0,0 +1,253 @@
+/*
+  Stand-in for the part of rapidjson's SAX api that ts_xapp.cpp uses, for
+  building the test harnesses where rapidjson isn't installed. Reader is a
+  small recursive descent parser that calls the handler the way rapidjson
+  does: non-negative integers go to Uint or Uint64, negative ones to Int or
+  Int64, anything with a fraction or exponent to Double, and object keys to
+  Key. Strings are unescaped into a buffer of the reader, so copy is always
+  true. Error codes and offsets are not rapidjson's, a failed parse is only
+  told apart from a successful one.
+*/
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#define RAPIDJSON_NAMESPACE rapidjson
+
+namespace rapidjson {
+
+typedef unsigned SizeType;
+
+template <typename CharType = char>
+struct UTF8 {
+  typedef CharType Ch;
+};
+
+enum ParseErrorCode { kParseErrorNone = 0, kParseErrorValueInvalid = 3 };
+
+struct ParseResult {
+  ParseErrorCode code = kParseErrorNone;
+  size_t offset = 0;
+
+  ParseErrorCode Code() const { return code; }
+  size_t Offset() const { return offset; }
+  operator bool() const { return code == kParseErrorNone; }
+};
+
+// reads a nil terminated string
+struct StringStream {
+  typedef char Ch;
+  const Ch *src;
+  const Ch *head;
+
+  StringStream( const Ch *src ) : src( src ), head( src ) {}
+  Ch Peek() const { return *src; }
+  Ch Take() { return *src++; }
+  size_t Tell() const { return src - head; }
+};
+
+// reads a buffer of known length, Peek returns '\0' at its end
+struct MemoryStream {
+  typedef char Ch;
+  const Ch *src;
+  const Ch *begin;
+  const Ch *end;
+
+  MemoryStream( const Ch *src, size_t size ) : src( src ), begin( src ), end( src + size ) {}
+  Ch Peek() const { return src == end ? '\0' : *src; }
+  Ch Take() { return src == end ? '\0' : *src++; }
+  size_t Tell() const { return src - begin; }
+};
+
+template <typename Encoding = UTF8<>, typename Derived = void>
+struct BaseReaderHandler {
+  typedef typename Encoding::Ch Ch;
+
+  Derived &Self() { return static_cast<Derived &>( *this ); }
+
+  bool Default() { return true; }
+  bool Null() { return Self().Default(); }
+  bool Bool( bool ) { return Self().Default(); }
+  bool Int( int ) { return Self().Default(); }
+  bool Uint( unsigned ) { return Self().Default(); }
+  bool Int64( int64_t ) { return Self().Default(); }
+  bool Uint64( uint64_t ) { return Self().Default(); }
+  bool Double( double ) { return Self().Default(); }
+  bool String( const Ch *, SizeType, bool ) { return Self().Default(); }
+  bool StartObject() { return Self().Default(); }
+  bool Key( const Ch *str, SizeType len, bool copy ) { return Self().String( str, len, copy ); }
+  bool EndObject( SizeType ) { return Self().Default(); }
+  bool StartArray() { return Self().Default(); }
+  bool EndArray( SizeType ) { return Self().Default(); }
+};
+
+class Reader {
+  private:
+    std::string str;  // unescaped string or number being parsed, reused between values
+
+    template <typename Stream>
+    static void SkipWhitespace( Stream &is ) {
+      while( is.Peek() == ' ' || is.Peek() == '\n' || is.Peek() == '\r' || is.Peek() == '\t' ) {
+        is.Take();
+      }
+    }
+
+    template <typename Stream>
+    static bool Consume( Stream &is, const char *literal ) {
+      for( ; *literal != '\0'; literal++ ) {
+        if( is.Take() != *literal ) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    template <typename Stream>
+    bool ParseString( Stream &is ) {
+      str.clear();
+      is.Take();  // opening quote
+      while( true ) {
+        char c = is.Take();
+        if( c == '"' ) {
+          return true;
+        }
+        if( c == '\0' ) {
+          return false;
+        }
+        if( c == '\\' ) {
+          c = is.Take();
+          switch( c ) {
+            case 'b': c = '\b'; break;
+            case 'f': c = '\f'; break;
+            case 'n': c = '\n'; break;
+            case 'r': c = '\r'; break;
+            case 't': c = '\t'; break;
+            case 'u':
+              for( int i = 0; i < 4; i++ ) {
+                is.Take();  // code points are not needed by the harnesses, kept as '?'
+              }
+              c = '?';
+              break;
+            case '\0': return false;
+            default: break;  // \" \\ and \/
+          }
+        }
+        str.push_back( c );
+      }
+    }
+
+    template <typename Stream, typename Handler>
+    bool ParseNumber( Stream &is, Handler &handler ) {
+      str.clear();
+      bool is_double = false;
+      while( strchr( "+-0123456789.eE", is.Peek() ) != nullptr && is.Peek() != '\0' ) {
+        char c = is.Take();
+        is_double = is_double || c == '.' || c == 'e' || c == 'E';
+        str.push_back( c );
+      }
+      if( str.empty() || str == "-" ) {
+        return false;
+      }
+
+      if( is_double ) {
+        return handler.Double( strtod( str.c_str(), nullptr ) );
+      }
+      if( str[0] == '-' ) {
+        int64_t i = strtoll( str.c_str(), nullptr, 10 );
+        return i >= INT32_MIN ? handler.Int( (int) i ) : handler.Int64( i );
+      }
+      uint64_t u = strtoull( str.c_str(), nullptr, 10 );
+      return u <= UINT32_MAX ? handler.Uint( (unsigned) u ) : handler.Uint64( u );
+    }
+
+    template <typename Stream, typename Handler>
+    bool ParseValue( Stream &is, Handler &handler ) {
+      SkipWhitespace( is );
+      switch( is.Peek() ) {
+        case '{': {
+          is.Take();
+          if( !handler.StartObject() ) {
+            return false;
+          }
+          SizeType members = 0;
+          SkipWhitespace( is );
+          if( is.Peek() == '}' ) {
+            is.Take();
+            return handler.EndObject( 0 );
+          }
+          while( true ) {
+            SkipWhitespace( is );
+            if( is.Peek() != '"' || !ParseString( is ) || !handler.Key( str.c_str(), (SizeType) str.size(), true ) ) {
+              return false;
+            }
+            SkipWhitespace( is );
+            if( is.Take() != ':' || !ParseValue( is, handler ) ) {
+              return false;
+            }
+            members++;
+            SkipWhitespace( is );
+            char c = is.Take();
+            if( c == '}' ) {
+              return handler.EndObject( members );
+            }
+            if( c != ',' ) {
+              return false;
+            }
+          }
+        }
+        case '[': {
+          is.Take();
+          if( !handler.StartArray() ) {
+            return false;
+          }
+          SizeType elements = 0;
+          SkipWhitespace( is );
+          if( is.Peek() == ']' ) {
+            is.Take();
+            return handler.EndArray( 0 );
+          }
+          while( true ) {
+            if( !ParseValue( is, handler ) ) {
+              return false;
+            }
+            elements++;
+            SkipWhitespace( is );
+            char c = is.Take();
+            if( c == ']' ) {
+              return handler.EndArray( elements );
+            }
+            if( c != ',' ) {
+              return false;
+            }
+          }
+        }
+        case '"':
+          return ParseString( is ) && handler.String( str.c_str(), (SizeType) str.size(), true );
+        case 't':
+          return Consume( is, "true" ) && handler.Bool( true );
+        case 'f':
+          return Consume( is, "false" ) && handler.Bool( false );
+        case 'n':
+          return Consume( is, "null" ) && handler.Null();
+        default:
+          return ParseNumber( is, handler );
+      }
+    }
+
+  public:
+    template <unsigned parseFlags = 0, typename Stream, typename Handler>
+    ParseResult Parse( Stream &is, Handler &handler ) {
+      ParseResult result;
+      bool ok = ParseValue( is, handler );
+      SkipWhitespace( is );
+      if( !ok || is.Peek() != '\0' ) {
+        result.code = kParseErrorValueInvalid;
+        result.offset = is.Tell();
+      }
+      return result;
+    }
+};
+
+}  // namespace rapidjson
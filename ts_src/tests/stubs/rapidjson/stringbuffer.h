@@ -0,0 +1,17 @@
+// Stand-in for rapidjson's StringBuffer, see reader.h
+#pragma once
+#include <string>
+
+namespace rapidjson {
+
+struct StringBuffer {
+  typedef char Ch;
+  std::string buf;
+
+  void Put( char c ) { buf.push_back( c ); }
+  void Clear() { buf.clear(); }
+  const char *GetString() const { return buf.c_str(); }
+  size_t GetSize() const { return buf.size(); }
+};
+
+}  // namespace rapidjson
@@ -0,0 +1,116 @@
+/*
+  Stand-in for rapidjson's Writer, see reader.h. Writes compact JSON and
+  takes the same SAX calls as a reader handler, so that a Document can be
+  written out by parsing it into a writer.
+*/
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "reader.h"
+#include "stringbuffer.h"
+
+namespace rapidjson {
+
+template <typename OutputStream>
+class Writer {
+  protected:
+    OutputStream *os;
+    std::vector<int> values;       // values written so far in each open object or array, keys included
+    std::vector<bool> is_object;   // whether each open value is an object rather than an array
+    int indent = 0;           // spaces per level, 0 writes everything on one line
+
+    void Raw( const char *str ) {
+      for( ; *str != '\0'; str++ ) {
+        os->Put( *str );
+      }
+    }
+
+    void NewLine() {
+      if( indent > 0 ) {
+        os->Put( '\n' );
+        for( size_t i = 0; i < values.size() * indent; i++ ) {
+          os->Put( ' ' );
+        }
+      }
+    }
+
+    // separates a value from the one before it, keys and their values are counted as two values
+    void Prefix() {
+      if( values.empty() ) {
+        return;
+      }
+      int n = values.back()++;
+      if( is_object.back() && n % 2 == 1 ) {
+        os->Put( ':' );
+        if( indent > 0 ) {
+          os->Put( ' ' );
+        }
+        return;
+      }
+      if( n > 0 ) {
+        os->Put( ',' );
+      }
+      NewLine();
+    }
+
+    bool Start( char c, bool object ) {
+      Prefix();
+      os->Put( c );
+      values.push_back( 0 );
+      is_object.push_back( object );
+      return true;
+    }
+
+    bool End( char c ) {
+      bool empty = values.back() == 0;
+      values.pop_back();
+      is_object.pop_back();
+      if( !empty ) {
+        NewLine();
+      }
+      os->Put( c );
+      return true;
+    }
+
+    bool Number( const std::string &str ) {
+      Prefix();
+      Raw( str.c_str() );
+      return true;
+    }
+
+  public:
+    Writer( OutputStream &os ) : os( &os ) {}
+
+    bool Null() { Prefix(); Raw( "null" ); return true; }
+    bool Bool( bool b ) { Prefix(); Raw( b ? "true" : "false" ); return true; }
+    bool Int( int i ) { return Number( std::to_string( i ) ); }
+    bool Uint( unsigned u ) { return Number( std::to_string( u ) ); }
+    bool Int64( int64_t i ) { return Number( std::to_string( i ) ); }
+    bool Uint64( uint64_t u ) { return Number( std::to_string( u ) ); }
+    bool Double( double d ) { return Number( std::to_string( d ) ); }
+
+    bool String( const char *str, SizeType length, bool copy = false ) {
+      Prefix();
+      os->Put( '"' );
+      for( SizeType i = 0; i < length; i++ ) {
+        if( str[i] == '"' || str[i] == '\\' ) {
+          os->Put( '\\' );
+        }
+        os->Put( str[i] );
+      }
+      os->Put( '"' );
+      return true;
+    }
+    bool String( const char *str ) { return String( str, (SizeType) strlen( str ) ); }
+    bool Key( const char *str, SizeType length, bool copy = false ) { return String( str, length, copy ); }
+    bool Key( const char *str ) { return String( str ); }
+
+    bool StartObject() { return Start( '{', true ); }
+    bool EndObject( SizeType memberCount = 0 ) { return End( '}' ); }
+    bool StartArray() { return Start( '[', false ); }
+    bool EndArray( SizeType elementCount = 0 ) { return End( ']' ); }
+};
+
+}  // namespace rapidjson
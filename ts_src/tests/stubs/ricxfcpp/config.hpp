@@ -0,0 +1,40 @@
+/*
+  Stand-in for the xapp-frame Config, which reads the controls section of
+  the xApp descriptor. Here the controls are set by the harness with Set
+  before the xApp reads them.
+*/
+#pragma once
+#include <map>
+#include <string>
+
+namespace xapp {
+
+class Config {
+  private:
+    static std::map<std::string, std::string> &Controls() {
+      static std::map<std::string, std::string> controls;
+      return controls;
+    }
+
+  public:
+    static void Set( const std::string &name, const std::string &value ) {
+      Controls()[name] = value;
+    }
+
+    std::string Get_control_str( const std::string &name ) {
+      auto it = Controls().find( name );
+      return it == Controls().end() ? "" : it->second;
+    }
+
+    int Get_control_value( const std::string &name, int defval ) {
+      auto it = Controls().find( name );
+      return it == Controls().end() ? defval : std::stoi( it->second );
+    }
+
+    bool Get_control_bool( const std::string &name, bool defval ) {
+      auto it = Controls().find( name );
+      return it == Controls().end() ? defval : it->second == "true";
+    }
+};
+
+}  // namespace xapp
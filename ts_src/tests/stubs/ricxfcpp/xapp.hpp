@@ -0,0 +1,125 @@
+/*
+  Stand-in for the xapp-frame Xapp and Message classes, for running the
+  TS-xApp callbacks without RMR. Messages queued with Xapp::Inject are
+  handed to the registered callbacks by Run, on as many threads as it is
+  given, the way RMR worker threads would. Unlike the real Run, it returns
+  once the queue is drained. Sent messages and responses are only counted.
+*/
+#pragma once
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace xapp {
+
+// payloads are owned by their message, the framework never frees them through a Msg_component
+struct unfreeit {
+  void operator()( unsigned char * ) {}
+};
+typedef std::unique_ptr<unsigned char, unfreeit> Msg_component;
+
+class Message {
+  private:
+    std::vector<unsigned char> payload;
+
+  public:
+    static const int NO_SUBID = -1;
+    static inline std::atomic<long> sent{0};       // Send_msg calls, from every thread
+    static inline std::atomic<long> responses{0};  // Send_response calls
+
+    Message( int size ) : payload( size ) {}
+
+    int Get_available_size() { return payload.size(); }
+    Msg_component Get_payload() { return Msg_component( payload.data() ); }
+    int Get_state() { return 0; }
+
+    bool Send_msg( int mtype, int subid, int payload_len, unsigned char *src ) {
+      sent++;
+      return true;
+    }
+
+    bool Send_response( int mtype, int subid, int response_len, unsigned char *response ) {
+      responses++;
+      return true;
+    }
+};
+
+typedef void ( *user_callback )( Message &m, int mtype, int subid, int payload_len, Msg_component payload, void *usr_data );
+
+class Xapp {
+  private:
+    struct Queued {
+      int mtype;
+      std::string payload;
+    };
+
+    static std::deque<Queued> &Queue() {
+      static std::deque<Queued> queue;
+      return queue;
+    }
+    static std::mutex &Queue_mutex() {
+      static std::mutex mtx;
+      return mtx;
+    }
+
+    std::map<int, std::pair<user_callback, void *>> callbacks;
+
+    void Work() {
+      while( true ) {
+        Queued msg;
+        {
+          std::lock_guard<std::mutex> lock( Queue_mutex() );
+          if( Queue().empty() ) {
+            return;
+          }
+          msg = std::move( Queue().front() );
+          Queue().pop_front();
+        }
+
+        auto cb = callbacks.find( msg.mtype );
+        if( cb == callbacks.end() ) {
+          continue;
+        }
+        Message mbuf( msg.payload.size() );
+        memcpy( mbuf.Get_payload().get(), msg.payload.data(), msg.payload.size() );
+        cb->second.first( mbuf, msg.mtype, Message::NO_SUBID, msg.payload.size(), mbuf.Get_payload(), cb->second.second );
+      }
+    }
+
+  public:
+    Xapp( const char *port, bool wait4rt ) {}
+
+    // queues a received message for the next Run
+    static void Inject( int mtype, const std::string &payload ) {
+      std::lock_guard<std::mutex> lock( Queue_mutex() );
+      Queue().push_back( Queued{ mtype, payload } );
+    }
+
+    std::unique_ptr<Message> Alloc_msg( int payload_size ) {
+      return std::unique_ptr<Message>( new Message( payload_size ) );
+    }
+
+    void Add_msg_cb( int mtype, user_callback fun, void *usr_data ) {
+      callbacks[mtype] = { fun, usr_data };
+    }
+
+    // runs the callbacks of the queued messages on nthreads threads, returning once all are handled
+    void Run( int nthreads ) {
+      std::vector<std::thread> threads;
+      for( int i = 1; i < nthreads; i++ ) {
+        threads.emplace_back( &Xapp::Work, this );
+      }
+      Work();
+      for( std::thread &t : threads ) {
+        t.join();
+      }
+    }
+};
+
+}  // namespace xapp
@@ -0,0 +1,7 @@
+// Stand-in for RMR's message type header, with the types ts_xapp.cpp uses
+#pragma once
+
+#define RIC_CONTROL_ACK  12011
+#define A1_POLICY_REQ    20010
+#define A1_POLICY_RESP   20011
+#define TS_UE_LIST       30000
@@ -0,0 +1,54 @@
+/*
+  Stand-in for the TS-xApp's restclient, for running it without a control
+  endpoint or E2 manager. Requests are answered by the functions the
+  harness sets in Endpoint, which are called concurrently from every thread
+  that posts. Created clients are counted, so a harness can tell how many
+  connections a real client would have opened.
+*/
+#pragma once
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+namespace restclient {
+
+struct response_t {
+  int status_code;
+  std::string body;
+};
+
+class RestClientException : public std::runtime_error {
+  public:
+    using std::runtime_error::runtime_error;
+};
+
+struct Endpoint {
+  static inline std::function<response_t( const std::string &path, const std::string &body )> post;
+  static inline std::function<response_t( const std::string &path )> get;
+  static inline std::atomic<long> clients{0};
+};
+
+class RestClient {
+  private:
+    std::string base_url;
+
+  public:
+    RestClient( std::string base_url ) : base_url( base_url ) {
+      Endpoint::clients++;
+    }
+
+    response_t do_post( std::string path, std::string json ) {
+      return Endpoint::post ? Endpoint::post( path, json ) : response_t{ 404, "" };
+    }
+
+    response_t do_get( std::string path ) {
+      return Endpoint::get ? Endpoint::get( path ) : response_t{ 404, "" };
+    }
+
+    std::string getBaseUrl() {
+      return base_url;
+    }
+};
+
+}  // namespace restclient
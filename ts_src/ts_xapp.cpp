@@ -40,6 +40,10 @@
 #include <unistd.h>
 
 #include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <algorithm>
@@ -54,6 +58,7 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/schema.h>
 #include <rapidjson/reader.h>
+#include <rapidjson/memorystream.h>
 #include <rapidjson/prettywriter.h>
 
 #include <rmr/RIC_message_types.h>
@@ -84,6 +89,7 @@
 #include <grpcpp/client_context.h>
 #include <grpcpp/create_channel.h>
 #include <grpcpp/security/credentials.h>
+#include <google/protobuf/arena.h>
 #include "protobuf/rc.grpc.pb.h"
 
 #include "utils/restclient.hpp"
@@ -102,14 +108,18 @@ using Keys = std::set<Key>;
 
 // ----------------------------------------------------------
 std::unique_ptr<Xapp> xfw;
-std::unique_ptr<rc::MsgComm::Stub> rc_stub;
 
-int downlink_threshold = 0;  // A1 policy type 20008 (in percentage)
+/*
+  Callbacks may run on several RMR worker threads at once (ts_rmr_threads in the xApp descriptor),
+  so everything they share is either atomic or an immutable snapshot that is swapped as a whole
+*/
+atomic<int> downlink_threshold{0};  // A1 policy type 20008 (in percentage)
 
 // scoped enum to identify which API is used to send control messages
 enum class TsControlApi { REST, gRPC };
 TsControlApi ts_control_api;  // api to send control messages
 string ts_control_ep;         // api target endpoint
+bool debug_logging = false;   // ts_debug_log in the xApp descriptor, logs full RMR payloads and control requests and replies
 
 typedef struct nodeb {
   string ran_name;
@@ -119,7 +129,10 @@ typedef struct nodeb {
   } global_nb_id;
 } nodeb_t;
 
-unordered_map<string, shared_ptr<nodeb_t>> cell_map; // maps each cell to its nodeb
+typedef unordered_map<string, shared_ptr<const nodeb_t>> cell_map_t;
+
+// maps each cell to its nodeb, built once by build_cell_mapping and only read through atomic_load afterwards
+shared_ptr<const cell_map_t> cell_map = make_shared<const cell_map_t>();
 
 /* struct UEData {
   string serving_cell;
@@ -149,31 +162,101 @@ static std::string base64_decode(const std::string &in) {
 	return out;
 }
 
-struct PolicyHandler : public BaseReaderHandler<UTF8<>, PolicyHandler> {
+/*
+  Compile-time key dispatch for the SAX handlers below. A handler lists the
+  keys it cares about in a KeyTable, in the same order as the values of its
+  key enum, and derives from KeyDispatchHandler, which looks up each key of
+  the message and keeps it as curr_key. Keys are hashed on their length and
+  first and last bytes into a table that is checked at compile time to be
+  free of collisions, so a lookup is one hash and at most one compare, and
+  keys the handler doesn't know cost no allocation nor string compares.
+*/
+constexpr size_t key_length( const char *key ) {
+  size_t len = 0;
+  while( key[len] != '\0' ) {
+    len++;
+  }
+  return len;
+}
+
+constexpr uint32_t key_hash( const char *key, size_t len ) {
+  return len == 0 ? 0 : (uint32_t) len * 131u + (unsigned char) key[0] * 31u + (unsigned char) key[len - 1];
+}
+
+template <typename KeyEnum, size_t N>
+struct KeyTable {
+  static constexpr int slot_bits = N <= 2 ? 3 : N <= 4 ? 4 : N <= 8 ? 5 : 6;  // at least 4 slots per key
+  static constexpr size_t slots = 1 << slot_bits;
+  static_assert( N <= 16, "KeyTable is meant for a handful of keys" );
+
+  const char *names[N];
+  size_t lengths[N];
+  int slot_key[slots];  // index into names, -1 for empty slots
+  bool collides;
+
+  // Fibonacci hashing, the top bits of the product are well mixed even for hashes that are close together
+  static constexpr size_t slot_of( const char *key, size_t len ) {
+    return ( key_hash( key, len ) * 2654435761u ) >> ( 32 - slot_bits );
+  }
+
+  constexpr KeyTable( const char *const (&keys)[N] ) : names(), lengths(), slot_key(), collides( false ) {
+    for( size_t i = 0; i < slots; i++ ) {
+      slot_key[i] = -1;
+    }
+    for( size_t i = 0; i < N; i++ ) {
+      names[i] = keys[i];
+      lengths[i] = key_length( keys[i] );
+      size_t slot = slot_of( keys[i], lengths[i] );
+      if( slot_key[slot] >= 0 ) {
+        collides = true;
+      }
+      slot_key[slot] = i;
+    }
+  }
+
+  // returns KeyEnum::unknown for keys that aren't in the table
+  KeyEnum find( const char *key, size_t len ) const {
+    int i = slot_key[slot_of( key, len )];
+    if( i < 0 || lengths[i] != len || memcmp( names[i], key, len ) != 0 ) {
+      return KeyEnum::unknown;
+    }
+    return static_cast<KeyEnum>( i );
+  }
+};
+
+template <typename Derived, typename KeyEnum, size_t N, const KeyTable<KeyEnum, N> &keys>
+struct KeyDispatchHandler : public BaseReaderHandler<UTF8<>, Derived> {
+  static_assert( !keys.collides, "two keys of the table hash to the same slot, adjust key_hash" );
+
+  KeyEnum curr_key = KeyEnum::unknown;
+
+  bool Key( const char* str, SizeType length, bool copy ) {
+    curr_key = keys.find( str, length );
+    return true;
+  }
+};
+
+enum class PolicyKey { policy_type_id, policy_instance_id, threshold, operation, unknown };
+inline constexpr KeyTable<PolicyKey, 4> policy_keys( { "policy_type_id", "policy_instance_id", "threshold", "operation" } );
+
+struct PolicyHandler : public KeyDispatchHandler<PolicyHandler, PolicyKey, 4, policy_keys> {
   /*
     Assuming we receive the following payload from A1 Mediator
     {"operation": "CREATE", "policy_type_id": 20008, "policy_instance_id": "tsapolicy145", "payload": {"threshold": 5}}
   */
-  unordered_map<string, string> cell_pred;
-  std::string ue_id;
-  bool ue_id_found = false;
-  string curr_key = "";
-  string curr_value = "";
   int policy_type_id;
   int policy_instance_id;
   int threshold;
   std::string operation;
   bool found_threshold = false;
 
-  bool Null() { return true; }
-  bool Bool(bool b) { return true; }
   bool Int(int i) {
 
-    if (curr_key.compare("policy_type_id") == 0) {
+    if (curr_key == PolicyKey::policy_type_id) {
       policy_type_id = i;
-    } else if (curr_key.compare("policy_instance_id") == 0) {
+    } else if (curr_key == PolicyKey::policy_instance_id) {
       policy_instance_id = i;
-    } else if (curr_key.compare("threshold") == 0) {
+    } else if (curr_key == PolicyKey::threshold) {
       found_threshold = true;
       threshold = i;
     }
@@ -182,41 +265,25 @@ struct PolicyHandler : public BaseReaderHandler<UTF8<>, PolicyHandler> {
   }
   bool Uint(unsigned u) {
 
-    if (curr_key.compare("policy_type_id") == 0) {
+    if (curr_key == PolicyKey::policy_type_id) {
       policy_type_id = u;
-    } else if (curr_key.compare("policy_instance_id") == 0) {
+    } else if (curr_key == PolicyKey::policy_instance_id) {
       policy_instance_id = u;
-    } else if (curr_key.compare("threshold") == 0) {
+    } else if (curr_key == PolicyKey::threshold) {
       found_threshold = true;
       threshold = u;
     }
 
     return true;
   }
-  bool Int64(int64_t i) {  return true; }
-  bool Uint64(uint64_t u) {  return true; }
-  bool Double(double d) {  return true; }
   bool String(const char* str, SizeType length, bool copy) {
 
-    if (curr_key.compare("operation") != 0) {
-      operation = str;
+    if (curr_key == PolicyKey::operation) {
+      operation.assign(str, length);
     }
 
     return true;
   }
-  bool StartObject() {
-
-    return true;
-  }
-  bool Key(const char* str, SizeType length, bool copy) {
-
-    curr_key = str;
-
-    return true;
-  }
-  bool EndObject(SizeType memberCount) {  return true; }
-  bool StartArray() {  return true; }
-  bool EndArray(SizeType elementCount) {  return true; }
 
 };
 
@@ -315,99 +382,87 @@ struct PredictionHandler : public BaseReaderHandler<UTF8<>, PredictionHandler> {
   bool EndArray(SizeType elementCount) {  return true; }
 };
 
-struct AnomalyHandler : public BaseReaderHandler<UTF8<>, AnomalyHandler> {
+enum class AnomalyKey { ue_id, unknown };
+inline constexpr KeyTable<AnomalyKey, 1> anomaly_keys( { "ue-id" } );
+
+struct AnomalyHandler : public KeyDispatchHandler<AnomalyHandler, AnomalyKey, 1, anomaly_keys> {
   /*
     Assuming we receive the following payload from AD
     [{"du-id": 1010, "ue-id": "Train passenger 2", "measTimeStampRf": 1620835470108, "Degradation": "RSRP RSSINR"}]
   */
   vector<string> prediction_ues;
-  string curr_key = "";
-
-  bool Key(const Ch* str, SizeType len, bool copy) {
-    curr_key = str;
-    return true;
-  }
 
   bool String(const Ch* str, SizeType len, bool copy) {
     // We are only interested in the "ue-id"
-    if ( curr_key.compare( "ue-id") == 0 ) {
-      prediction_ues.push_back( str );
+    if ( curr_key == AnomalyKey::ue_id ) {
+      prediction_ues.emplace_back( str, len );
     }
     return true;
   }
 };
 
 
-struct TrafficSituationHandler : public BaseReaderHandler<UTF8<>, TrafficSituationHandler> {
+enum class TrafficSituationKey { uid, unknown };
+inline constexpr KeyTable<TrafficSituationKey, 1> traffic_situation_keys( { "uid" } );
+
+struct TrafficSituationHandler : public KeyDispatchHandler<TrafficSituationHandler, TrafficSituationKey, 1, traffic_situation_keys> {
   /*
     Assuming we receive the following payload from TM
     [{"uid": "RU_0", "sit": "LOW_TRAFFIC"}, {"uid": "RU_1", "sit": "LOW_TRAFFIC"}, ...]
   */
   vector<string> investigate_RUs;
-  string curr_key = "";
-
-  bool Key(const Ch* str, SizeType len, bool copy) {
-    curr_key = str;
-    return true;
-  }
 
   bool String(const Ch* str, SizeType len, bool copy) {
     // We are only interested in the "RU-uid" (actually want the situation type also, idk how to get it)
-    if ( curr_key.compare("uid") == 0 ) {
-      investigate_RUs.push_back( str );
+    if ( curr_key == TrafficSituationKey::uid ) {
+      investigate_RUs.emplace_back( str, len );
     }
     return true;
   }
 };
 
-struct NodebListHandler : public BaseReaderHandler<UTF8<>, NodebListHandler> {
-  vector<string> nodeb_list;
-  string curr_key = "";
+enum class NodebListKey { inventoryName, unknown };
+inline constexpr KeyTable<NodebListKey, 1> nodeb_list_keys( { "inventoryName" } );
 
-  bool Key(const Ch* str, SizeType length, bool copy) {
-    curr_key = str;
-    return true;
-  }
+struct NodebListHandler : public KeyDispatchHandler<NodebListHandler, NodebListKey, 1, nodeb_list_keys> {
+  vector<string> nodeb_list;
 
   bool String(const Ch* str, SizeType length, bool copy) {
-    if( curr_key.compare( "inventoryName" ) == 0 ) {
-      nodeb_list.push_back( str );
+    if( curr_key == NodebListKey::inventoryName ) {
+      nodeb_list.emplace_back( str, length );
     }
     return true;
   }
 };
 
-struct NodebHandler : public BaseReaderHandler<UTF8<>, NodebHandler> {
-	string curr_key = "";
+enum class NodebKey { ranName, plmnId, nbId, e2nodeComponentRequestPart, unknown };
+inline constexpr KeyTable<NodebKey, 4> nodeb_keys( { "ranName", "plmnId", "nbId", "e2nodeComponentRequestPart" } );
+
+struct NodebHandler : public KeyDispatchHandler<NodebHandler, NodebKey, 4, nodeb_keys> {
 	shared_ptr<nodeb_t> nodeb = make_shared<nodeb_t>();
 	std::string meid;
 	std::vector<string> cells;
 
-	bool Key(const Ch* str, SizeType length, bool copy) {
-		curr_key = str;
-		return true;
-	}
-
 	bool String(const Ch* str, SizeType length, bool copy) {
 
-		if (curr_key.compare("ranName") == 0) {
+		if (curr_key == NodebKey::ranName) {
 			//std::cout << str << "\n";
-			nodeb->ran_name = str;
-			meid= str;
+			nodeb->ran_name.assign(str, length);
+			meid.assign(str, length);
 			//std::cout << "\n meid = " << meid;
 
 		}
-		else if (curr_key.compare("plmnId") == 0) {
+		else if (curr_key == NodebKey::plmnId) {
 			//std::cout << str << "\n";
-			nodeb->global_nb_id.plmn_id = str;
+			nodeb->global_nb_id.plmn_id.assign(str, length);
 		}
-		else if (curr_key.compare("nbId") == 0) {
+		else if (curr_key == NodebKey::nbId) {
 			//std::cout <<str<< "\n";
-			nodeb->global_nb_id.nb_id = str;
+			nodeb->global_nb_id.nb_id.assign(str, length);
 		}
-		else if (curr_key.compare("e2nodeComponentRequestPart") == 0) {
+		else if (curr_key == NodebKey::e2nodeComponentRequestPart) {
 			//std::cout << str<<"\n";
-			auto message = base64_decode(str);
+			auto message = base64_decode(string(str, length));
 			//std::cout << message<<"\n";
 			int len = meid.length();
 			//std::cout << "\n meid = " << meid;
@@ -444,11 +499,6 @@ struct NodebHandler : public BaseReaderHandler<UTF8<>, NodebHandler> {
 
 						}
 					}
-					len = cells.size();
-					for (int i = 0; i < len; i++) {
-						cell_map[cells[i]] = nodeb;
-					}
-
 		}
 		return true;
 	}
@@ -583,51 +633,168 @@ struct NodebHandler : public BaseReaderHandler<UTF8<>, NodebHandler> {
   return return_ue_data_map;
 } */
 
-void policy_callback( Message& mbuf, int mtype, int subid, int len, Msg_component payload,  void* data ) {
-  string arg ((const char*)payload.get(), len); // RMR payload might not have a nil terminanted char
+/*
+  Parses an RMR payload straight out of the message buffer. The stream is
+  bounded by len rather than a nil terminator, which RMR payloads might not
+  have, so nothing is copied. The reader stops at a nil as it does at the
+  end of the stream, so a payload is only accepted if the document runs to
+  len or is followed by nothing but nil padding; anything after an embedded
+  nil fails the parse instead of being silently dropped. The payload itself
+  is only logged with ts_debug_log, as it can be large.
+*/
+template <typename Handler>
+bool parse_payload( Msg_component &payload, int len, Handler &handler ) {
+  const char *json = (const char *) payload.get();
+
+  if( debug_logging ) {
+    cout << "[DEBUG] Payload is ";
+    cout.write( json, len ) << endl;
+  }
+
+  Reader reader;
+  MemoryStream ms( json, len );
+  ParseResult result = reader.Parse( ms, handler );
+  if( !result ) {
+    cout << "[ERROR] Unable to parse payload of length " << len << ", error code " << result.Code()
+         << " at offset " << result.Offset() << endl;
+    return false;
+  }
+
+  size_t end = ms.Tell();
+  for( size_t i = end; i < (size_t) len; i++ ) {
+    if( json[i] != '\0' ) {
+      cout << "[ERROR] Unable to parse payload of length " << len << ", unexpected data after a nil at offset " << end << endl;
+      return false;
+    }
+  }
+
+  return true;
+}
 
+void policy_callback( Message& mbuf, int mtype, int subid, int len, Msg_component payload,  void* data ) {
   cout << "[INFO] Policy Callback got a message, type=" << mtype << ", length=" << len << "\n";
-  cout << "[INFO] Payload is " << arg << endl;
 
   PolicyHandler handler;
-  Reader reader;
-  StringStream ss(arg.c_str());
-  reader.Parse(ss,handler);
+  if( !parse_payload( payload, len, handler ) ) {
+    return;
+  }
 
   //Set the threshold value
   if (handler.found_threshold) {
     cout << "[INFO] Setting Threshold for A1-P value: " << handler.threshold << "%\n";
-    downlink_threshold = handler.threshold;
+    downlink_threshold.store( handler.threshold );
   }
 
 }
 
-// sends a handover message through REST
-void send_rest_control_request( string ue_id, string serving_cell_id, string target_cell_id ) {
+// handover of a single UE, as sent to the control endpoint
+struct ControlRequest {
+  string ue_id;
+  string serving_cell_id;  // only used by the REST api
+  string target_cell_id;
+};
+
+/*
+  Pool of keep-alive REST clients for the control endpoint. Each client keeps
+  its connection open between requests, so a burst of handovers costs one TCP
+  handshake per pooled client rather than one per handover. A client is only
+  used by one thread at a time, callers wait for one to be returned when all
+  of them are in use. Clients are created on first use, and one whose request
+  failed is dropped, to be reconnected the next time it is leased.
+*/
+class RestClientPool {
+  private:
+    string base_url;
+    int pool_size;
+    vector<unique_ptr<restclient::RestClient>> idle;  // nullptr for clients that are yet to be (re)created
+    mutex mtx;
+    condition_variable returned;
+
+  public:
+    RestClientPool( string base_url, int size ) : base_url( base_url ), pool_size( size ), idle( size ) {}
+
+    int size() {
+      return pool_size;
+    }
+
+    // lent out client, returned to the pool when it goes out of scope
+    class Lease {
+      private:
+        RestClientPool *pool;
+        unique_ptr<restclient::RestClient> client;
+
+      public:
+        Lease( RestClientPool *pool, unique_ptr<restclient::RestClient> client ) : pool( pool ), client( move( client ) ) {}
+        Lease( Lease &&other ) : pool( other.pool ), client( move( other.client ) ) {
+          other.pool = nullptr;
+        }
+        ~Lease() {
+          if( pool != nullptr ) {
+            pool->give_back( move( client ) );
+          }
+        }
+
+        // may throw restclient::RestClientException if the client has to be (re)created
+        restclient::RestClient &get() {
+          if( client == nullptr ) {
+            client = unique_ptr<restclient::RestClient>( new restclient::RestClient( pool->base_url ) );
+          }
+          return *client;
+        }
+
+        // drops the client's connection, e.g. after it failed
+        void discard() {
+          client.reset();
+        }
+    };
+
+    Lease lease() {
+      unique_lock<mutex> lock( mtx );
+      returned.wait( lock, [this] { return !idle.empty(); } );
+
+      unique_ptr<restclient::RestClient> client = move( idle.back() );
+      idle.pop_back();
+      return Lease( this, move( client ) );
+    }
+
+    void give_back( unique_ptr<restclient::RestClient> client ) {
+      {
+        lock_guard<mutex> lock( mtx );
+        idle.push_back( move( client ) );
+      }
+      returned.notify_one();
+    }
+};
+
+std::unique_ptr<RestClientPool> rest_pool;
+
+// posts a HandOff request for a single UE through one of the pooled clients
+void post_handoff( const ControlRequest &control ) {
   time_t now;
   string str_now;
-  static unsigned int seq_number = 0; // static counter, not thread-safe
+  static atomic<unsigned int> seq_number{0}; // shared by all RMR worker threads
 
   // building a handoff control message
+  char time_buf[32];
   now = time( nullptr );
-  str_now = ctime( &now );
+  str_now = ctime_r( &now, time_buf ); // ctime returns a static buffer, which isn't thread-safe
   str_now.pop_back(); // removing the \n character
 
-  seq_number++;       // static counter, not thread-safe
+  unsigned int seq = ++seq_number; // every request gets its own number, even if sent concurrently
 
   rapidjson::StringBuffer s;
-  rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(s);
+  rapidjson::Writer<rapidjson::StringBuffer> writer(s);
   writer.StartObject();
   writer.Key( "command" );
   writer.String( "HandOff" );
   writer.Key( "seqNo" );
-  writer.Int( seq_number );
+  writer.Int( seq );
   writer.Key( "ue" );
-  writer.String( ue_id.c_str() );
+  writer.String( control.ue_id.c_str() );
   writer.Key( "fromCell" );
-  writer.String( serving_cell_id.c_str() );
+  writer.String( control.serving_cell_id.c_str() );
   writer.Key( "toCell" );
-  writer.String( target_cell_id.c_str() );
+  writer.String( control.target_cell_id.c_str() );
   writer.Key( "timestamp" );
   writer.String( str_now.c_str() );
   writer.Key( "reason" );
@@ -647,25 +814,28 @@ void send_rest_control_request( string ue_id, string serving_cell_id, string tar
     "ttl": 10
   } */
 
-  string msg = s.GetString();
-
-  cout << "[INFO] Sending a HandOff CONTROL message to \"" << ts_control_ep << "\"\n";
-  cout << "[INFO] HandOff request is " << msg << endl;
+  if( debug_logging ) {
+    cout << "[DEBUG] HandOff request is " << s.GetString() << endl;
+  }
 
+  RestClientPool::Lease lease = rest_pool->lease();
   try {
-    // sending request
-    restclient::RestClient client( ts_control_ep );
-    restclient::response_t resp = client.do_post( "", msg ); // we already have the full path in ts_control_ep
+    restclient::RestClient &client = lease.get();
+    restclient::response_t resp = client.do_post( "", s.GetString() ); // we already have the full path in ts_control_ep
 
     if( resp.status_code == 200 ) {
         // ============== DO SOMETHING USEFUL HERE ===============
-        // Currently, we only print out the HandOff reply
-        rapidjson::Document document;
-        document.Parse( resp.body.c_str() );
-        rapidjson::StringBuffer s;
-        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(s);
-        document.Accept( writer );
-        cout << "[INFO] HandOff reply is " << s.GetString() << endl;
+        // Currently, we only log the HandOff reply, which is only worth re-formatting when debugging
+        cout << "[INFO] HandOff of UE " << control.ue_id << " to " << control.target_cell_id << " accepted, seqNo " << seq << endl;
+
+        if( debug_logging ) {
+          rapidjson::Document document;
+          document.Parse( resp.body.c_str() );
+          rapidjson::StringBuffer reply;
+          rapidjson::PrettyWriter<rapidjson::StringBuffer> reply_writer(reply);
+          document.Accept( reply_writer );
+          cout << "[DEBUG] HandOff reply is " << reply.GetString() << endl;
+        }
 
     } else {
         cout << "[ERROR] Unexpected HTTP code " << resp.status_code << " from " << \
@@ -675,17 +845,41 @@ void send_rest_control_request( string ue_id, string serving_cell_id, string tar
 
   } catch( const restclient::RestClientException &e ) {
     cout << "[ERROR] " << e.what() << endl;
-
+    lease.discard();
   }
+}
+
+/*
+  Sends handover messages through REST, one after the other on the calling
+  thread. Concurrency comes from the RMR worker threads (ts_rmr_threads):
+  callbacks running at the same time each lease their own pooled client, so
+  up to ts_rest_pool_size requests are in flight without starting threads
+  per batch.
+*/
+void send_rest_control_requests( const vector<ControlRequest> &controls ) {
+  cout << "[INFO] Sending " << controls.size() << " HandOff CONTROL messages to \"" << ts_control_ep << "\"\n";
 
+  for( const ControlRequest &control : controls ) {
+    post_handoff( control );
+  }
 }
 
-// sends a handover message to RC xApp through gRPC
-void send_grpc_control_request( string ue_id, string target_cell_id ) {
-  grpc::ClientContext context;
+// sends a handover message through REST
+void send_rest_control_request( string ue_id, string serving_cell_id, string target_cell_id ) {
+  send_rest_control_requests( { ControlRequest{ ue_id, serving_cell_id, target_cell_id } } );
+}
 
-  rc::RicControlGrpcRsp response;
-  shared_ptr<rc::RicControlGrpcReq> request = make_shared<rc::RicControlGrpcReq>();
+/*
+  Fills in a RIC control request handing a UE over to a target cell.
+  Returns false if the target cell isn't in the cell map, since the request
+  can't be routed to any E2 node then.
+*/
+bool fill_control_request( rc::RicControlGrpcReq *request, const ControlRequest &control, const cell_map_t &cells ) {
+  auto data = cells.find( control.target_cell_id );
+  if( data == cells.end() ) {
+    cout << "[INFO] Cannot find RAN name corresponding to cell id = " << control.target_cell_id << endl;
+    return false;
+  }
 
   rc::RICE2APHeader *apHeader = request->mutable_rice2apheaderdata();
   apHeader->set_ranfuncid(3);
@@ -696,70 +890,146 @@ void send_grpc_control_request( string ue_id, string target_cell_id ) {
   ctrlHeader->set_controlactionid( 1 );
   rc::UeId *ueid =  ctrlHeader->mutable_ueid();
   rc::gNBUEID* gnbue= ueid->mutable_gnbueid();
-  gnbue->set_amfuengapid(stoi(ue_id));
-  gnbue->add_gnbcuuef1apid(stoi(ue_id));
-  gnbue->add_gnbcucpuee1apid(stoi(ue_id));
+  gnbue->set_amfuengapid(stoi(control.ue_id));
+  gnbue->add_gnbcuuef1apid(stoi(control.ue_id));
+  gnbue->add_gnbcucpuee1apid(stoi(control.ue_id));
   rc::Guami* gumi=gnbue->mutable_guami();
   //As of now hardcoded according to the value setted in VIAVI RSG TOOL
   gumi->set_amfregionid("10100000");
   gumi->set_amfsetid("0000000000");
   gumi->set_amfpointer("000001");
-  
-  //ctrlHeader->set_ueid( ue_id );
+  gumi->set_plmnidentity(data->second->global_nb_id.plmn_id);
 
   rc::RICControlMessage *ctrlMsg = request->mutable_riccontrolmessagedata();
   ctrlMsg->set_riccontrolcelltypeval( rc::RICControlCellTypeEnum::RIC_CONTROL_CELL_UNKWON );
-  //ctrlMsg->set_riccontrolcelltypeval( api::RIC_CONTROL_CELL_UNKWON);
-    
-    ctrlMsg->set_targetcellid( target_cell_id);
-
-  auto data = cell_map.find(target_cell_id);
-  if( data != cell_map.end() ) {
-    request->set_e2nodeid( data->second->global_nb_id.nb_id );
-    request->set_plmnid( data->second->global_nb_id.plmn_id );
-    request->set_ranname( data->second->ran_name );
-    gumi->set_plmnidentity(data->second->global_nb_id.plmn_id);
-  } else {
-    cout << "[INFO] Cannot find RAN name corresponding to cell id = "<<target_cell_id<<endl;
-    return;
-    request->set_e2nodeid( "unknown_e2nodeid" );
-    request->set_plmnid( "unknown_plmnid" );
-    request->set_ranname( "unknown_ranname" );
-    gumi->set_plmnidentity("unknown_plmnid");
-  }
+  ctrlMsg->set_targetcellid( control.target_cell_id );
+
+  request->set_e2nodeid( data->second->global_nb_id.nb_id );
+  request->set_plmnid( data->second->global_nb_id.plmn_id );
+  request->set_ranname( data->second->ran_name );
   request->set_riccontrolackreqval( rc::RICControlAckEnum::RIC_CONTROL_ACK_UNKWON );
   //request->set_riccontrolackreqval( api::RIC_CONTROL_ACK_UNKWON);  // not yet used in api.proto
- cout<<"\nin ts xapp grpc message content \n"<< request->DebugString()<<"\n"; 
-  grpc::Status status = rc_stub->SendRICControlReqServiceGrpc( &context, *request, &response );
 
-  if( status.ok() ) {
-    if( response.rspcode() == 0 ) {
-      cout << "[INFO] Control Request succeeded with code=0, description=" << response.description() << endl;
-    } else {
-      cout << "[ERROR] Control Request failed with code=" << response.rspcode()
-           << ", description=" << response.description() << endl;
+  return true;
+}
+
+/*
+  Asynchronous client for RIC control requests to the RC xApp. Requests are
+  started on a completion queue and their replies are handled by a thread of
+  its own, so a slow RC xApp never blocks the RMR callback that sent them.
+  At most max_in_flight requests are outstanding at once, senders wait for a
+  free slot beyond that, and every request gives up after its deadline so
+  that slots are always freed eventually.
+*/
+class RcControlClient {
+  private:
+    // state of a single outstanding request, freed once its reply has been handled
+    struct AsyncCall {
+      google::protobuf::Arena arena;  // request and response live here, freed in one go with the call
+      grpc::ClientContext context;
+      grpc::Status status;
+      rc::RicControlGrpcRsp *response;
+      unique_ptr<grpc::ClientAsyncResponseReader<rc::RicControlGrpcRsp>> reader;
+      string ue_id;
+    };
+
+    unique_ptr<rc::MsgComm::Stub> stub;
+    grpc::CompletionQueue cq;
+    thread completion_thread;
+    mutex mtx;
+    condition_variable slot_free;
+    int in_flight = 0;
+    int max_in_flight;
+    chrono::milliseconds deadline;
+
+    void handle_replies() {
+      void *tag;
+      bool ok;
+
+      while( cq.Next( &tag, &ok ) ) {
+        unique_ptr<AsyncCall> call( static_cast<AsyncCall *>( tag ) );
+
+        if( !ok || !call->status.ok() ) {
+          cout << "[ERROR] failed to send a RIC Control Request message for UE " << call->ue_id << " to RC xApp, error_code="
+               << call->status.error_code() << ", error_msg=" << call->status.error_message() << endl;
+        } else if( call->response->rspcode() == 0 ) {
+          cout << "[INFO] Control Request for UE " << call->ue_id << " succeeded with code=0, description=" << call->response->description() << endl;
+        } else {
+          cout << "[ERROR] Control Request for UE " << call->ue_id << " failed with code=" << call->response->rspcode()
+               << ", description=" << call->response->description() << endl;
+        }
+
+        {
+          lock_guard<mutex> lock( mtx );
+          in_flight--;
+        }
+        slot_free.notify_one();
+      }
     }
 
-  } else {
-    cout << "[ERROR] failed to send a RIC Control Request message to RC xApp, error_code="
-         << status.error_code() << ", error_msg=" << status.error_message() << endl;
-  }
+  public:
+    RcControlClient( shared_ptr<grpc::Channel> channel, int max_in_flight, int deadline_ms ) :
+      stub( rc::MsgComm::NewStub( channel, grpc::StubOptions() ) ),
+      max_in_flight( max_in_flight ),
+      deadline( deadline_ms ) {
+      completion_thread = thread( &RcControlClient::handle_replies, this );
+    }
+
+    // waits for the replies of outstanding requests, which at most takes one deadline
+    ~RcControlClient() {
+      cq.Shutdown();
+      completion_thread.join();
+    }
 
+    /*
+      Starts one request per control and returns without waiting for replies.
+      The rc.proto request carries a single UeId, so controls can't be coalesced
+      into one request; a batch is instead started back to back, against one
+      snapshot of the cell map.
+    */
+    void send( const vector<ControlRequest> &controls ) {
+      shared_ptr<const cell_map_t> cells = atomic_load( &cell_map );
+
+      for( const ControlRequest &control : controls ) {
+        unique_ptr<AsyncCall> call( new AsyncCall() );
+        rc::RicControlGrpcReq *request = google::protobuf::Arena::CreateMessage<rc::RicControlGrpcReq>( &call->arena );
+        call->response = google::protobuf::Arena::CreateMessage<rc::RicControlGrpcRsp>( &call->arena );
+        call->ue_id = control.ue_id;
+
+        if( !fill_control_request( request, control, *cells ) ) {
+          continue;
+        }
+
+        {
+          unique_lock<mutex> lock( mtx );
+          slot_free.wait( lock, [this] { return in_flight < max_in_flight; } );
+          in_flight++;
+        }
+
+        cout << "[INFO] Sending a RIC Control Request for UE " << control.ue_id << " to cell " << control.target_cell_id << endl;
+
+        call->context.set_deadline( chrono::system_clock::now() + deadline );
+        call->reader = stub->PrepareAsyncSendRICControlReqServiceGrpc( &call->context, *request, &cq );
+        call->reader->StartCall();
+        call->reader->Finish( call->response, &call->status, call.get() );
+        call.release(); // owned by the completion queue until handle_replies takes it
+      }
+    }
+};
+
+std::unique_ptr<RcControlClient> rc_client;
+
+// sends a handover message to RC xApp through gRPC, without waiting for its reply
+void send_grpc_control_request( string ue_id, string target_cell_id ) {
+  rc_client->send( { ControlRequest{ ue_id, "", target_cell_id } } );
 }
 
 void prediction_callback( Message& mbuf, int mtype, int subid, int len, Msg_component payload,  void* data ) {
-  string json ((char *)payload.get(), len); // RMR payload might not have a nil terminanted char
-
   cout << "[INFO] Prediction Callback got a message, type=" << mtype << ", length=" << len << "\n";
-  cout << "[INFO] Payload is " << json << endl;
 
   PredictionHandler handler;
-  try {
-    Reader reader;
-    StringStream ss(json.c_str());
-    reader.Parse(ss,handler);
-  } catch (...) {
-    cout << "[ERROR] Got an exception on stringstream read parse\n";
+  if( !parse_payload( payload, len, handler ) ) {
+    return;
   }
 
   // We are only considering download throughput
@@ -845,18 +1115,12 @@ void send_handover_decisions( vector<HandoverStruct> handover_decisions ) {
 }
 
 void handover_prediction_callback( Message& mbuf, int mtype, int subid, int len, Msg_component payload,  void* data ) {
-  string json ((char *)payload.get(), len); // RMR payload might not have a nil terminanted char
-
   cout << "[INFO] Prediction Callback got a message, type=" << mtype << ", length=" << len << "\n";
-  cout << "[INFO] Payload is " << json << endl;
 
+  // a malformed list is dropped as a whole rather than executing the handovers parsed before the error
   HandoverHandler handler;
-  try {
-    Reader reader;
-    StringStream ss(json.c_str());
-    reader.Parse(ss,handler);
-  } catch (...) {
-    cout << "[ERROR] Got an exception on stringstream read parse\n";
+  if( !parse_payload( payload, len, handler ) ) {
+    return;
   }
 
   send_handover_decisions(handler.handovers);
@@ -957,19 +1221,18 @@ void send_investigation_request( vector<string> rus_to_investigate ) {
  * sends a prediction request to the QP Driver xApp.
  */
 void ad_callback( Message& mbuf, int mtype, int subid, int len, Msg_component payload, void* data ) {
-  string json ((char *)payload.get(), len); // RMR payload might not have a nil terminanted char
-
   cout << "[INFO] AD Callback got a message, type=" << mtype << ", length=" << len << "\n";
-  cout << "[INFO] Payload is " << json << "\n";
 
   AnomalyHandler handler;
-  Reader reader;
-  StringStream ss(json.c_str());
-  reader.Parse(ss,handler);
+  bool parsed = parse_payload( payload, len, handler );
 
   // just sending ACK to the AD xApp
   mbuf.Send_response( TS_ANOMALY_ACK, Message::NO_SUBID, len, nullptr );  // msg type 30004
 
+  if( !parsed ) {
+    return;
+  }
+
   send_prediction_request(handler.prediction_ues);
 }
 
@@ -978,15 +1241,12 @@ void ad_callback( Message& mbuf, int mtype, int subid, int len, Msg_component pa
  * sake of waking slept RUs in order to increase network capacity.
  */
 void tm_callback( Message& mbuf, int mtype, int subid, int len, Msg_component payload, void* data ) {
-  string json ((char *)payload.get(), len); // RMR payload might not have a nil terminanted char
-
   cout << "[INFO] Received TM-situation, type=" << mtype << ", length=" << len << "\n";
-  cout << "[INFO] Payload is " << json << "\n";
 
   TrafficSituationHandler handler;
-  Reader reader;
-  StringStream ss(json.c_str());
-  reader.Parse(ss,handler);
+  if( !parse_payload( payload, len, handler ) ) {
+    return;
+  }
 
   // returns an ACK to the TM xApp
   //mbuf.Send_response( TM_SIT_ACK, Message::NO_SUBID, len, nullptr );  // msg type 30035
@@ -1027,6 +1287,9 @@ bool build_cell_mapping() {
     base_url = string( data );
   }
 
+  // the mapping is built aside and published in one go, so concurrent callbacks never see it half built
+  shared_ptr<cell_map_t> cells = make_shared<cell_map_t>();
+
   try {
     restclient::RestClient client( base_url );
 
@@ -1051,6 +1314,10 @@ bool build_cell_mapping() {
         Reader reader;
         StringStream ss( response.body.c_str() );
         reader.Parse( ss, handler );
+
+        for( string &cell : handler.cells ) {
+          (*cells)[cell] = handler.nodeb;
+        }
       } catch (...) {
         cout << "[ERROR] Got an exception on parsing nodeb (stringstream read parse)\n";
         return false;
@@ -1062,23 +1329,33 @@ bool build_cell_mapping() {
     return false;
   }
 
+  atomic_store( &cell_map, shared_ptr<const cell_map_t>( cells ) );
   return true;
 }
 
 extern int main( int argc, char** argv ) {
-  int nthreads = 1;
   char*	port = (char *) "4560";
   shared_ptr<grpc::Channel> channel;
 
   Config *config = new Config();
+  int nthreads = config->Get_control_value( "ts_rmr_threads", 1 ); // RMR worker threads running the callbacks
+  if ( nthreads < 1 ) {
+    cout << "[ERROR] ts_rmr_threads must be at least 1, got " << nthreads << ", using 1\n";
+    nthreads = 1;
+  }
   string api = config->Get_control_str("ts_control_api");
   ts_control_ep = config->Get_control_str("ts_control_ep");
   if ( api.empty() ) {
     cout << "[ERROR] a control api (rest/grpc) is required in xApp descriptor\n";
     exit(1);
   }
+  debug_logging = config->Get_control_bool( "ts_debug_log", false );
   if ( api.compare("rest") == 0 ) {
     ts_control_api = TsControlApi::REST;
+
+    // keep-alive connections to the control endpoint, as many requests as this can be in flight at once
+    int pool_size = max( 1, config->Get_control_value( "ts_rest_pool_size", 8 ) );
+    rest_pool = std::unique_ptr<RestClientPool>( new RestClientPool( ts_control_ep, pool_size ) );
   } else {
     ts_control_api = TsControlApi::gRPC;
 
@@ -1086,11 +1363,15 @@ extern int main( int argc, char** argv ) {
       cout << "[ERROR] unable to map cells to nodeb\n";
     }
 
+    // requests beyond ts_grpc_in_flight wait for a reply, each reply is waited for at most ts_grpc_deadline_ms
+    int max_in_flight = max( 1, config->Get_control_value( "ts_grpc_in_flight", 64 ) );
+    int deadline_ms = max( 1, config->Get_control_value( "ts_grpc_deadline_ms", 1000 ) );
+
     channel = grpc::CreateChannel(ts_control_ep, grpc::InsecureChannelCredentials());
-    rc_stub = rc::MsgComm::NewStub(channel, grpc::StubOptions());
+    rc_client = std::unique_ptr<RcControlClient>( new RcControlClient( channel, max_in_flight, deadline_ms ) );
   }
 
-  fprintf( stderr, "[INFO] listening on port %s\n", port );
+  fprintf( stderr, "[INFO] listening on port %s with %d RMR worker threads\n", port, nthreads );
   xfw = std::unique_ptr<Xapp>( new Xapp( port, true ) );
 
   xfw->Add_msg_cb( A1_POLICY_REQ, policy_callback, NULL );              // Register a callback function for msg type 20010
@@ -1099,4 +1380,5 @@ extern int main( int argc, char** argv ) {
 
   xfw->Run( nthreads );
 
+  return 0;
 }